@@ -0,0 +1,128 @@
+#include "CatalogSnapshot.h"
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MKFNetInternal {
+
+namespace {
+    constexpr std::string_view snapshotFormatTag = "MKFNET-CATALOGS-1\n";
+}
+
+#if defined(_WIN32)
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    _fileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (_fileHandle == INVALID_HANDLE_VALUE) {
+        _fileHandle = nullptr;
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(_fileHandle, &fileSize)) {
+        CloseHandle(_fileHandle);
+        throw std::runtime_error("Cannot read the size of " + path.string());
+    }
+    _size = static_cast<size_t>(fileSize.QuadPart);
+    if (_size == 0) {
+        return;
+    }
+    _mappingHandle = CreateFileMappingW(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mappingHandle != nullptr) {
+        _data = static_cast<const uint8_t*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (_data == nullptr) {
+        if (_mappingHandle != nullptr) {
+            CloseHandle(_mappingHandle);
+        }
+        CloseHandle(_fileHandle);
+        throw std::runtime_error("Cannot map " + path.string());
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (_data != nullptr) {
+        UnmapViewOfFile(_data);
+    }
+    if (_mappingHandle != nullptr) {
+        CloseHandle(_mappingHandle);
+    }
+    if (_fileHandle != nullptr) {
+        CloseHandle(_fileHandle);
+    }
+}
+#else
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    int fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0) {
+        close(fileDescriptor);
+        throw std::runtime_error("Cannot read the size of " + path.string());
+    }
+    _size = static_cast<size_t>(fileStatus.st_size);
+    if (_size > 0) {
+        void* mapping = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+        if (mapping == MAP_FAILED) {
+            close(fileDescriptor);
+            throw std::runtime_error("Cannot map " + path.string());
+        }
+        _data = static_cast<const uint8_t*>(mapping);
+    }
+    // The mapping stays valid once the descriptor is closed
+    close(fileDescriptor);
+}
+
+MappedFile::~MappedFile() {
+    if (_data != nullptr) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+}
+#endif
+
+void write_catalog_snapshot(const nlohmann::json& catalogs, const std::filesystem::path& snapshotPath) {
+    std::vector<uint8_t> snapshot(snapshotFormatTag.begin(), snapshotFormatTag.end());
+    nlohmann::json::to_msgpack(catalogs, snapshot);
+
+    auto temporaryPath = snapshotPath;
+    temporaryPath += ".partial" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream snapshotFile(temporaryPath, std::ios::binary | std::ios::trunc);
+        snapshotFile.write(reinterpret_cast<const char*>(snapshot.data()), snapshot.size());
+        if (!snapshotFile) {
+            throw std::runtime_error("Cannot write " + temporaryPath.string());
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, snapshotPath, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath);
+        throw std::runtime_error("Cannot replace " + snapshotPath.string() + ": " + error.message());
+    }
+}
+
+nlohmann::json read_catalog_snapshot(const std::filesystem::path& snapshotPath) {
+    MappedFile snapshot(snapshotPath);
+    if (snapshot.size() < snapshotFormatTag.size() || std::string_view(reinterpret_cast<const char*>(snapshot.data()), snapshotFormatTag.size()) != snapshotFormatTag) {
+        throw std::runtime_error(snapshotPath.string() + " is not a catalog snapshot");
+    }
+    // Parsed straight from the mapped pages, without reading the file into a buffer; the catalogs built from it
+    // are still a private copy in each process
+    return nlohmann::json::from_msgpack(snapshot.data() + snapshotFormatTag.size(), snapshot.data() + snapshot.size());
+}
+
+} // namespace MKFNetInternal
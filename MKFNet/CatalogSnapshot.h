@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <json.hpp>
+
+namespace MKFNetInternal {
+
+// Read-only mapping of a whole file, read without copying it into a buffer first
+class MappedFile {
+    private:
+        const uint8_t* _data = nullptr;
+        size_t _size = 0;
+#if defined(_WIN32)
+        void* _fileHandle = nullptr;
+        void* _mappingHandle = nullptr;
+#endif
+
+    public:
+        explicit MappedFile(const std::filesystem::path& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const uint8_t* data() const {
+            return _data;
+        }
+        size_t size() const {
+            return _size;
+        }
+};
+
+// Catalogs in the layout load_databases takes, {"coreMaterials": {name: material}, "coreShapes": ...},
+// stored as one MessagePack document behind a format tag, a cache that loads faster than the MAS NDJSON text.
+// Snapshots are written to a temporary file and renamed into place, so workers starting meanwhile never map a partial one
+void write_catalog_snapshot(const nlohmann::json& catalogs, const std::filesystem::path& snapshotPath);
+nlohmann::json read_catalog_snapshot(const std::filesystem::path& snapshotPath);
+
+} // namespace MKFNetInternal
@@ -0,0 +1,261 @@
+#include "CoreMaterialCache.h"
+#include "InitialPermeability.h"
+#include "InputsWrapper.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+namespace MKFNetInternal {
+
+namespace {
+    const double minimumMagneticFluxDensity = 0.005;
+    const double maximumMagneticFluxDensity = 0.5;
+    const double minimumFrequency = 1e3;
+    const double maximumFrequency = 1e7;
+    const size_t numberPointsPerDecade = 5;
+    // At least three, for the quadratic interpolation in temperature
+    const std::vector<double> coreLossesTemperatures = {25, 50, 75, 100, 125};
+    const double missingPoint = std::numeric_limits<double>::quiet_NaN();
+    const double maximumMagneticFieldDcBias = 1e4;
+
+    std::vector<double> logarithmicGrid(double minimum, double maximum) {
+        std::vector<double> grid;
+        size_t numberPoints = size_t(std::round(std::log10(maximum / minimum) * numberPointsPerDecade)) + 1;
+        for (size_t pointIndex = 0; pointIndex < numberPoints; pointIndex++) {
+            grid.push_back(std::log(minimum) + (std::log(maximum) - std::log(minimum)) * pointIndex / (numberPoints - 1));
+        }
+        return grid;
+    }
+
+    // Index of the lower neighbour and weight of the upper one, or empty outside the grid
+    std::optional<std::pair<size_t, double>> locate(const std::vector<double>& grid, double value) {
+        if (grid.size() == 1) {
+            return std::make_pair(size_t(0), 0.0);
+        }
+        if (value < grid.front() || value > grid.back()) {
+            return std::nullopt;
+        }
+        size_t upperIndex = std::clamp(size_t(std::upper_bound(grid.begin(), grid.end(), value) - grid.begin()), size_t(1), grid.size() - 1);
+        double weight = (value - grid[upperIndex - 1]) / (grid[upperIndex] - grid[upperIndex - 1]);
+        return std::make_pair(upperIndex - 1, weight);
+    }
+
+    std::pair<size_t, double> locateClamped(const std::vector<double>& grid, double value) {
+        return locate(grid, std::clamp(value, grid.front(), grid.back())).value();
+    }
+}
+
+OpenMagnetics::OperatingPointExcitation create_magnetic_flux_density_excitation(OpenMagnetics::WaveformLabel shape, double magneticFluxDensityPeak, double frequency, double dutyCycle) {
+    OpenMagnetics::Processed processed;
+    processed.set_label(shape);
+    processed.set_offset(0);
+    processed.set_peak_to_peak(2 * magneticFluxDensityPeak);
+    processed.set_duty_cycle(dutyCycle);
+    auto waveform = OpenMagnetics::InputsWrapper::create_waveform(processed, frequency);
+    auto sampledWaveform = OpenMagnetics::InputsWrapper::calculate_sampled_waveform(waveform, frequency);
+    auto harmonics = OpenMagnetics::InputsWrapper::calculate_harmonics_data(sampledWaveform, frequency);
+
+    OpenMagnetics::SignalDescriptor magneticFluxDensity;
+    magneticFluxDensity.set_waveform(waveform);
+    magneticFluxDensity.set_harmonics(harmonics);
+    magneticFluxDensity.set_processed(OpenMagnetics::InputsWrapper::calculate_processed_data(harmonics, waveform, true));
+
+    OpenMagnetics::OperatingPointExcitation excitation;
+    excitation.set_frequency(frequency);
+    excitation.set_magnetic_flux_density(magneticFluxDensity);
+    return excitation;
+}
+
+CoreLossesDensitySurface::CoreLossesDensitySurface(const OpenMagnetics::CoreMaterial& coreMaterial, OpenMagnetics::CoreLossesModels modelName) {
+    _logMagneticFluxDensities = logarithmicGrid(minimumMagneticFluxDensity, maximumMagneticFluxDensity);
+    _logFrequencies = logarithmicGrid(minimumFrequency, maximumFrequency);
+    _temperatures = coreLossesTemperatures;
+
+    auto coreLossesModel = OpenMagnetics::CoreLossesModel::factory(modelName);
+    _logVolumetricLosses.reserve(_logMagneticFluxDensities.size() * _logFrequencies.size() * _temperatures.size());
+    for (auto logMagneticFluxDensity : _logMagneticFluxDensities) {
+        for (auto logFrequency : _logFrequencies) {
+            auto excitation = create_magnetic_flux_density_excitation(OpenMagnetics::WaveformLabel::SINUSOIDAL, std::exp(logMagneticFluxDensity), std::exp(logFrequency));
+            for (auto temperature : _temperatures) {
+                // A failing point must not throw the whole surface away, or every later call would build it again
+                double volumetricLosses = 0;
+                try {
+                    volumetricLosses = coreLossesModel->get_core_volumetric_losses(coreMaterial, excitation, temperature);
+                }
+                catch (...) {
+                }
+                if (volumetricLosses > 0 && std::isfinite(volumetricLosses)) {
+                    _logVolumetricLosses.push_back(std::log(volumetricLosses));
+                    _numberValidPoints++;
+                }
+                else {
+                    _logVolumetricLosses.push_back(missingPoint);
+                }
+            }
+        }
+    }
+}
+
+double CoreLossesDensitySurface::get_log_volumetric_losses(size_t magneticFluxDensityIndex, double magneticFluxDensityWeight, size_t frequencyIndex, double frequencyWeight, size_t temperatureIndex) const {
+    double logVolumetricLosses = 0;
+    for (size_t cornerIndex = 0; cornerIndex < 4; cornerIndex++) {
+        size_t magneticFluxDensityOffset = cornerIndex & 1;
+        size_t frequencyOffset = (cornerIndex >> 1) & 1;
+        double weight = (magneticFluxDensityOffset? magneticFluxDensityWeight : 1 - magneticFluxDensityWeight) *
+                        (frequencyOffset? frequencyWeight : 1 - frequencyWeight);
+        if (weight == 0) {
+            continue;
+        }
+        size_t index = ((magneticFluxDensityIndex + magneticFluxDensityOffset) * _logFrequencies.size() + frequencyIndex + frequencyOffset) * _temperatures.size() + temperatureIndex;
+        // NaN of a missing corner carries through to the caller
+        logVolumetricLosses += weight * _logVolumetricLosses[index];
+    }
+    return logVolumetricLosses;
+}
+
+std::optional<double> CoreLossesDensitySurface::get_volumetric_losses(double magneticFluxDensityPeak, double frequency, double temperature) const {
+    if (magneticFluxDensityPeak <= 0 || frequency <= 0) {
+        return std::nullopt;
+    }
+    auto magneticFluxDensityPosition = locate(_logMagneticFluxDensities, std::log(magneticFluxDensityPeak));
+    auto frequencyPosition = locate(_logFrequencies, std::log(frequency));
+    auto temperaturePosition = locate(_temperatures, temperature);
+    if (!magneticFluxDensityPosition || !frequencyPosition || !temperaturePosition) {
+        return std::nullopt;
+    }
+
+    auto [magneticFluxDensityIndex, magneticFluxDensityWeight] = magneticFluxDensityPosition.value();
+    auto [frequencyIndex, frequencyWeight] = frequencyPosition.value();
+    auto [temperatureIndex, temperatureWeight] = temperaturePosition.value();
+    // Losses are quadratic in temperature in the usual temperature factors, so the three nodes closest to the
+    // requested temperature are fitted exactly by a parabola
+    size_t closestTemperatureIndex = temperatureIndex + (temperatureWeight > 0.5? 1 : 0);
+    size_t firstTemperatureIndex = std::clamp(closestTemperatureIndex, size_t(1), _temperatures.size() - 2) - 1;
+    double volumetricLosses = 0;
+    for (size_t nodeIndex = firstTemperatureIndex; nodeIndex < firstTemperatureIndex + 3; nodeIndex++) {
+        double logVolumetricLosses = get_log_volumetric_losses(magneticFluxDensityIndex, magneticFluxDensityWeight, frequencyIndex, frequencyWeight, nodeIndex);
+        if (std::isnan(logVolumetricLosses)) {
+            return std::nullopt;
+        }
+        double basis = 1;
+        for (size_t otherNodeIndex = firstTemperatureIndex; otherNodeIndex < firstTemperatureIndex + 3; otherNodeIndex++) {
+            if (otherNodeIndex != nodeIndex) {
+                basis *= (temperature - _temperatures[otherNodeIndex]) / (_temperatures[nodeIndex] - _temperatures[otherNodeIndex]);
+            }
+        }
+        volumetricLosses += basis * std::exp(logVolumetricLosses);
+    }
+    if (volumetricLosses <= 0) {
+        return std::nullopt;
+    }
+    return volumetricLosses;
+}
+
+InitialPermeabilitySurface::InitialPermeabilitySurface(const OpenMagnetics::CoreMaterial& coreMaterial) {
+    _magneticFieldsDcBias.push_back(0);
+    for (auto logMagneticField : logarithmicGrid(1, maximumMagneticFieldDcBias)) {
+        _magneticFieldsDcBias.push_back(std::exp(logMagneticField));
+    }
+    for (double temperature = -40; temperature <= 200; temperature += 10) {
+        _temperatures.push_back(temperature);
+    }
+
+    OpenMagnetics::InitialPermeability initialPermeability;
+    _initialPermeabilities.reserve(_magneticFieldsDcBias.size() * _temperatures.size());
+    for (auto magneticFieldDcBias : _magneticFieldsDcBias) {
+        for (auto temperature : _temperatures) {
+            _initialPermeabilities.push_back(initialPermeability.get_initial_permeability(coreMaterial, temperature, magneticFieldDcBias, std::nullopt));
+        }
+    }
+}
+
+double InitialPermeabilitySurface::get_initial_permeability(double magneticFieldDcBias, double temperature) const {
+    // Permeability curves flatten out at both ends, so values outside the grid take the closest edge
+    auto [magneticFieldIndex, magneticFieldWeight] = locateClamped(_magneticFieldsDcBias, std::abs(magneticFieldDcBias));
+    auto [temperatureIndex, temperatureWeight] = locateClamped(_temperatures, temperature);
+    size_t magneticFieldUpperIndex = std::min(magneticFieldIndex + 1, _magneticFieldsDcBias.size() - 1);
+    size_t temperatureUpperIndex = std::min(temperatureIndex + 1, _temperatures.size() - 1);
+    auto at = [this](size_t magneticFieldIndex, size_t temperatureIndex) {
+        return _initialPermeabilities[magneticFieldIndex * _temperatures.size() + temperatureIndex];
+    };
+    return (1 - magneticFieldWeight) * ((1 - temperatureWeight) * at(magneticFieldIndex, temperatureIndex) + temperatureWeight * at(magneticFieldIndex, temperatureUpperIndex)) +
+           magneticFieldWeight * ((1 - temperatureWeight) * at(magneticFieldUpperIndex, temperatureIndex) + temperatureWeight * at(magneticFieldUpperIndex, temperatureUpperIndex));
+}
+
+CoreMaterialCache& CoreMaterialCache::get_instance() {
+    static CoreMaterialCache instance;
+    return instance;
+}
+
+std::shared_ptr<const OpenMagnetics::CoreMaterial> CoreMaterialCache::get_material(const std::string& materialName) {
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        auto materialIterator = _materials.find(materialName);
+        if (materialIterator != _materials.end()) {
+            return materialIterator->second;
+        }
+    }
+    auto material = std::make_shared<const OpenMagnetics::CoreMaterial>(OpenMagnetics::find_core_material_by_name(materialName));
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    return _materials.emplace(materialName, material).first->second;
+}
+
+std::shared_ptr<const CoreLossesDensitySurface> CoreMaterialCache::get_core_losses_density_surface(const std::string& materialName, OpenMagnetics::CoreLossesModels modelName) {
+    auto key = std::make_pair(materialName, modelName);
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        auto surfaceIterator = _coreLossesDensitySurfaces.find(key);
+        if (surfaceIterator != _coreLossesDensitySurfaces.end()) {
+            return surfaceIterator->second;
+        }
+    }
+    // Built outside the lock so lookups of other materials are not blocked; if two threads race, the first surface stored wins
+    auto surface = std::make_shared<const CoreLossesDensitySurface>(*get_material(materialName), modelName);
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    return _coreLossesDensitySurfaces.emplace(key, surface).first->second;
+}
+
+std::shared_ptr<const InitialPermeabilitySurface> CoreMaterialCache::get_initial_permeability_surface(const std::string& materialName) {
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        auto surfaceIterator = _initialPermeabilitySurfaces.find(materialName);
+        if (surfaceIterator != _initialPermeabilitySurfaces.end()) {
+            return surfaceIterator->second;
+        }
+    }
+    auto surface = std::make_shared<const InitialPermeabilitySurface>(*get_material(materialName));
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    return _initialPermeabilitySurfaces.emplace(materialName, surface).first->second;
+}
+
+void CoreMaterialCache::clear() {
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    _materials.clear();
+    _coreLossesDensitySurfaces.clear();
+    _initialPermeabilitySurfaces.clear();
+}
+
+CoreMaterialCache::MemoryUsage CoreMaterialCache::get_memory_usage() const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    MemoryUsage memoryUsage;
+    memoryUsage.numberSurfaces = _coreLossesDensitySurfaces.size() + _initialPermeabilitySurfaces.size();
+    for (auto& [key, surface] : _coreLossesDensitySurfaces) {
+        memoryUsage.surfaceBytes += surface->get_memory_usage();
+    }
+    for (auto& [materialName, surface] : _initialPermeabilitySurfaces) {
+        memoryUsage.surfaceBytes += surface->get_memory_usage();
+    }
+    return memoryUsage;
+}
+
+std::vector<std::shared_ptr<const OpenMagnetics::CoreMaterial>> CoreMaterialCache::get_materials() const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    std::vector<std::shared_ptr<const OpenMagnetics::CoreMaterial>> materials;
+    for (auto& [materialName, material] : _materials) {
+        materials.push_back(material);
+    }
+    return materials;
+}
+
+} // namespace MKFNetInternal
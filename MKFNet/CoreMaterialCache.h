@@ -0,0 +1,89 @@
+#pragma once
+#include "CoreLosses.h"
+#include <map>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace MKFNetInternal {
+
+// Magnetic flux density excitation of the given shape, centred on zero, with harmonics and processed data filled in
+OpenMagnetics::OperatingPointExcitation create_magnetic_flux_density_excitation(OpenMagnetics::WaveformLabel shape, double magneticFluxDensityPeak, double frequency, double dutyCycle = 0.5);
+
+// Sinusoidal volumetric core losses of one material and model over a (peak B, frequency, temperature) grid,
+// interpolated bilinearly on the logarithm of the losses, B and frequency, and quadratically on the losses over
+// the three closest temperatures, which follows the minimum ferrites have in temperature.
+// Points the model failed at or gave no positive losses for are kept as NaN and never interpolated
+class CoreLossesDensitySurface {
+    private:
+        std::vector<double> _logMagneticFluxDensities;
+        std::vector<double> _logFrequencies;
+        std::vector<double> _temperatures;
+        std::vector<double> _logVolumetricLosses;
+        size_t _numberValidPoints = 0;
+
+        double get_log_volumetric_losses(size_t magneticFluxDensityIndex, double magneticFluxDensityWeight, size_t frequencyIndex, double frequencyWeight, size_t temperatureIndex) const;
+
+    public:
+        CoreLossesDensitySurface(const OpenMagnetics::CoreMaterial& coreMaterial, OpenMagnetics::CoreLossesModels modelName);
+
+        // Empty outside the grid or next to a missing point, where the caller has to evaluate the model itself
+        std::optional<double> get_volumetric_losses(double magneticFluxDensityPeak, double frequency, double temperature) const;
+
+        // True when the model failed everywhere, usually because the material has no data for it
+        bool is_empty() const {
+            return _numberValidPoints == 0;
+        }
+
+        size_t get_memory_usage() const {
+            return sizeof(CoreLossesDensitySurface) + (_logMagneticFluxDensities.capacity() + _logFrequencies.capacity() + _temperatures.capacity() + _logVolumetricLosses.capacity()) * sizeof(double);
+        }
+};
+
+// Initial permeability of one material over a (DC bias field, temperature) grid, interpolated bilinearly
+class InitialPermeabilitySurface {
+    private:
+        std::vector<double> _magneticFieldsDcBias;
+        std::vector<double> _temperatures;
+        std::vector<double> _initialPermeabilities;
+
+    public:
+        explicit InitialPermeabilitySurface(const OpenMagnetics::CoreMaterial& coreMaterial);
+
+        double get_initial_permeability(double magneticFieldDcBias, double temperature) const;
+
+        size_t get_memory_usage() const {
+            return sizeof(InitialPermeabilitySurface) + (_magneticFieldsDcBias.capacity() + _temperatures.capacity() + _initialPermeabilities.capacity()) * sizeof(double);
+        }
+};
+
+// Resolved catalog materials and their precomputed curves, built on first use and shared by every thread
+class CoreMaterialCache {
+    private:
+        std::map<std::string, std::shared_ptr<const OpenMagnetics::CoreMaterial>> _materials;
+        std::map<std::pair<std::string, OpenMagnetics::CoreLossesModels>, std::shared_ptr<const CoreLossesDensitySurface>> _coreLossesDensitySurfaces;
+        std::map<std::string, std::shared_ptr<const InitialPermeabilitySurface>> _initialPermeabilitySurfaces;
+        mutable std::shared_mutex _mutex;
+
+    public:
+        struct MemoryUsage {
+            size_t numberSurfaces = 0;
+            size_t surfaceBytes = 0;
+        };
+
+        static CoreMaterialCache& get_instance();
+
+        std::shared_ptr<const OpenMagnetics::CoreMaterial> get_material(const std::string& materialName);
+        std::shared_ptr<const CoreLossesDensitySurface> get_core_losses_density_surface(const std::string& materialName, OpenMagnetics::CoreLossesModels modelName);
+        std::shared_ptr<const InitialPermeabilitySurface> get_initial_permeability_surface(const std::string& materialName);
+
+        void clear();
+        // Memory of the surface grids; materials are left to the caller, through get_materials
+        MemoryUsage get_memory_usage() const;
+        std::vector<std::shared_ptr<const OpenMagnetics::CoreMaterial>> get_materials() const;
+};
+
+} // namespace MKFNetInternal
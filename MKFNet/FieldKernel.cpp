@@ -0,0 +1,192 @@
+#include "FieldKernel.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <numbers>
+#include <thread>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MKFNET_FIELD_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace MKFNetInternal {
+
+namespace {
+    const double minimumSquaredDistance = 1e-30;
+    const double fieldFactor = 1 / (2 * std::numbers::pi);
+    // Below this many point-source interactions, handing work to another thread costs more than it saves
+    const size_t minimumInteractionsPerThread = 1 << 20;
+}
+
+FieldSources add_mirrored_sources(const FieldSources& sources, double windowMinimumX, double windowMaximumX, double windowMinimumY, double windowMaximumY, size_t mirroringDimension) {
+    FieldSources mirroredSources;
+    int mirrors = int(mirroringDimension);
+    double windowWidth = windowMaximumX - windowMinimumX;
+    double windowHeight = windowMaximumY - windowMinimumY;
+
+    // Image k lies at x + k * width for even k, and at the reflection 2 * minimum - x shifted by (k + 1) * width for odd k
+    auto mirror = [](double coordinate, double minimum, double length, int imageIndex) {
+        if (imageIndex % 2 == 0) {
+            return coordinate + imageIndex * length;
+        }
+        return 2 * minimum - coordinate + (imageIndex + 1) * length;
+    };
+
+    size_t numberImages = size_t(2 * mirrors + 1) * size_t(2 * mirrors + 1);
+    mirroredSources.x.reserve(sources.size() * numberImages);
+    mirroredSources.y.reserve(sources.size() * numberImages);
+    mirroredSources.radius.reserve(sources.size() * numberImages);
+    mirroredSources.current.reserve(sources.size() * numberImages);
+    for (int imageIndexX = -mirrors; imageIndexX <= mirrors; imageIndexX++) {
+        for (int imageIndexY = -mirrors; imageIndexY <= mirrors; imageIndexY++) {
+            for (size_t sourceIndex = 0; sourceIndex < sources.size(); sourceIndex++) {
+                mirroredSources.push_back(mirror(sources.x[sourceIndex], windowMinimumX, windowWidth, imageIndexX),
+                                          mirror(sources.y[sourceIndex], windowMinimumY, windowHeight, imageIndexY),
+                                          sources.radius[sourceIndex],
+                                          sources.current[sourceIndex]);
+            }
+        }
+    }
+    return mirroredSources;
+}
+
+void calculate_magnetic_field_strength_scalar(const FieldSources& sources, const double* pointsX, const double* pointsY, size_t numberPoints, double* fieldX, double* fieldY) {
+    for (size_t pointIndex = 0; pointIndex < numberPoints; pointIndex++) {
+        double pointFieldX = 0;
+        double pointFieldY = 0;
+        for (size_t sourceIndex = 0; sourceIndex < sources.size(); sourceIndex++) {
+            double distanceX = pointsX[pointIndex] - sources.x[sourceIndex];
+            double distanceY = pointsY[pointIndex] - sources.y[sourceIndex];
+            double squaredDistance = distanceX * distanceX + distanceY * distanceY;
+            double squaredRadius = sources.radius[sourceIndex] * sources.radius[sourceIndex];
+            double scale = sources.current[sourceIndex] / std::max({squaredDistance, squaredRadius, minimumSquaredDistance});
+            pointFieldX -= scale * distanceY;
+            pointFieldY += scale * distanceX;
+        }
+        fieldX[pointIndex] = pointFieldX * fieldFactor;
+        fieldY[pointIndex] = pointFieldY * fieldFactor;
+    }
+}
+
+#ifdef MKFNET_FIELD_KERNEL_X86
+__attribute__((target("avx2,fma")))
+void calculate_magnetic_field_strength_avx2(const FieldSources& sources, const double* pointsX, const double* pointsY, size_t numberPoints, double* fieldX, double* fieldY) {
+    const size_t width = 4;
+    size_t vectorizedNumberPoints = numberPoints - numberPoints % width;
+    const __m256d factor = _mm256_set1_pd(fieldFactor);
+    for (size_t pointIndex = 0; pointIndex < vectorizedNumberPoints; pointIndex += width) {
+        __m256d pointX = _mm256_loadu_pd(pointsX + pointIndex);
+        __m256d pointY = _mm256_loadu_pd(pointsY + pointIndex);
+        __m256d pointFieldX = _mm256_setzero_pd();
+        __m256d pointFieldY = _mm256_setzero_pd();
+        for (size_t sourceIndex = 0; sourceIndex < sources.size(); sourceIndex++) {
+            __m256d distanceX = _mm256_sub_pd(pointX, _mm256_set1_pd(sources.x[sourceIndex]));
+            __m256d distanceY = _mm256_sub_pd(pointY, _mm256_set1_pd(sources.y[sourceIndex]));
+            __m256d squaredDistance = _mm256_fmadd_pd(distanceX, distanceX, _mm256_mul_pd(distanceY, distanceY));
+            double squaredRadius = std::max(sources.radius[sourceIndex] * sources.radius[sourceIndex], minimumSquaredDistance);
+            __m256d denominator = _mm256_max_pd(squaredDistance, _mm256_set1_pd(squaredRadius));
+            __m256d scale = _mm256_div_pd(_mm256_set1_pd(sources.current[sourceIndex]), denominator);
+            pointFieldX = _mm256_fnmadd_pd(scale, distanceY, pointFieldX);
+            pointFieldY = _mm256_fmadd_pd(scale, distanceX, pointFieldY);
+        }
+        _mm256_storeu_pd(fieldX + pointIndex, _mm256_mul_pd(pointFieldX, factor));
+        _mm256_storeu_pd(fieldY + pointIndex, _mm256_mul_pd(pointFieldY, factor));
+    }
+    calculate_magnetic_field_strength_scalar(sources, pointsX + vectorizedNumberPoints, pointsY + vectorizedNumberPoints, numberPoints - vectorizedNumberPoints, fieldX + vectorizedNumberPoints, fieldY + vectorizedNumberPoints);
+}
+
+__attribute__((target("avx512f")))
+void calculate_magnetic_field_strength_avx512(const FieldSources& sources, const double* pointsX, const double* pointsY, size_t numberPoints, double* fieldX, double* fieldY) {
+    const size_t width = 8;
+    size_t vectorizedNumberPoints = numberPoints - numberPoints % width;
+    const __m512d factor = _mm512_set1_pd(fieldFactor);
+    for (size_t pointIndex = 0; pointIndex < vectorizedNumberPoints; pointIndex += width) {
+        __m512d pointX = _mm512_loadu_pd(pointsX + pointIndex);
+        __m512d pointY = _mm512_loadu_pd(pointsY + pointIndex);
+        __m512d pointFieldX = _mm512_setzero_pd();
+        __m512d pointFieldY = _mm512_setzero_pd();
+        for (size_t sourceIndex = 0; sourceIndex < sources.size(); sourceIndex++) {
+            __m512d distanceX = _mm512_sub_pd(pointX, _mm512_set1_pd(sources.x[sourceIndex]));
+            __m512d distanceY = _mm512_sub_pd(pointY, _mm512_set1_pd(sources.y[sourceIndex]));
+            __m512d squaredDistance = _mm512_fmadd_pd(distanceX, distanceX, _mm512_mul_pd(distanceY, distanceY));
+            double squaredRadius = std::max(sources.radius[sourceIndex] * sources.radius[sourceIndex], minimumSquaredDistance);
+            // Zero-masked form, as the unmasked one trips a false uninitialized warning in GCC 12 headers
+            __m512d denominator = _mm512_maskz_max_pd(__mmask8(0xFF), squaredDistance, _mm512_set1_pd(squaredRadius));
+            __m512d scale = _mm512_div_pd(_mm512_set1_pd(sources.current[sourceIndex]), denominator);
+            pointFieldX = _mm512_fnmadd_pd(scale, distanceY, pointFieldX);
+            pointFieldY = _mm512_fmadd_pd(scale, distanceX, pointFieldY);
+        }
+        _mm512_storeu_pd(fieldX + pointIndex, _mm512_mul_pd(pointFieldX, factor));
+        _mm512_storeu_pd(fieldY + pointIndex, _mm512_mul_pd(pointFieldY, factor));
+    }
+    calculate_magnetic_field_strength_scalar(sources, pointsX + vectorizedNumberPoints, pointsY + vectorizedNumberPoints, numberPoints - vectorizedNumberPoints, fieldX + vectorizedNumberPoints, fieldY + vectorizedNumberPoints);
+}
+#endif
+
+FieldKernelInstructionSet get_field_kernel_instruction_set() {
+#ifdef MKFNET_FIELD_KERNEL_X86
+    static const FieldKernelInstructionSet instructionSet = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return FieldKernelInstructionSet::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return FieldKernelInstructionSet::AVX2;
+        }
+        return FieldKernelInstructionSet::SCALAR;
+    }();
+    return instructionSet;
+#else
+    return FieldKernelInstructionSet::SCALAR;
+#endif
+}
+
+size_t get_field_kernel_number_threads(size_t numberInteractions, size_t maximumNumberThreads) {
+    if (maximumNumberThreads == 0) {
+        maximumNumberThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::clamp(numberInteractions / minimumInteractionsPerThread, size_t(1), maximumNumberThreads);
+}
+
+void calculate_magnetic_field_strength(const FieldSources& sources, const double* pointsX, const double* pointsY, size_t numberPoints, double* fieldX, double* fieldY, FieldKernelInstructionSet instructionSet, ThreadPool* pool) {
+    instructionSet = FieldKernelInstructionSet(std::min(int(instructionSet), int(get_field_kernel_instruction_set())));
+    auto kernel = calculate_magnetic_field_strength_scalar;
+#ifdef MKFNET_FIELD_KERNEL_X86
+    if (instructionSet == FieldKernelInstructionSet::AVX512) {
+        kernel = calculate_magnetic_field_strength_avx512;
+    }
+    else if (instructionSet == FieldKernelInstructionSet::AVX2) {
+        kernel = calculate_magnetic_field_strength_avx2;
+    }
+#endif
+
+    size_t numberThreads = 1;
+    if (pool != nullptr) {
+        numberThreads = get_field_kernel_number_threads(numberPoints * std::max(size_t(1), sources.size()), pool->get_number_threads());
+    }
+    if (numberThreads == 1) {
+        kernel(sources, pointsX, pointsY, numberPoints, fieldX, fieldY);
+        return;
+    }
+
+    // Chunks stay multiples of eight points so only the last one runs a scalar tail
+    size_t chunkSize = ((numberPoints + numberThreads - 1) / numberThreads + 7) / 8 * 8;
+    std::vector<std::future<void>> chunks;
+    for (size_t firstPoint = 0; firstPoint < numberPoints; firstPoint += chunkSize) {
+        size_t chunkNumberPoints = std::min(chunkSize, numberPoints - firstPoint);
+        chunks.push_back(pool->submit([=, &sources] {
+            kernel(sources, pointsX + firstPoint, pointsY + firstPoint, chunkNumberPoints, fieldX + firstPoint, fieldY + firstPoint);
+        }));
+    }
+    for (auto& chunk : chunks) {
+        chunk.get();
+    }
+}
+
+void calculate_magnetic_field_strength(const FieldSources& sources, const double* pointsX, const double* pointsY, size_t numberPoints, double* fieldX, double* fieldY) {
+    calculate_magnetic_field_strength(sources, pointsX, pointsY, numberPoints, fieldX, fieldY, get_field_kernel_instruction_set());
+}
+
+} // namespace MKFNetInternal
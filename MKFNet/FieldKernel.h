@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace MKFNetInternal {
+
+class ThreadPool;
+
+// Straight conductors perpendicular to the winding window plane, stored as parallel arrays
+struct FieldSources {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> radius;
+    std::vector<double> current;
+
+    size_t size() const {
+        return x.size();
+    }
+    void push_back(double sourceX, double sourceY, double sourceRadius, double sourceCurrent) {
+        x.push_back(sourceX);
+        y.push_back(sourceY);
+        radius.push_back(sourceRadius);
+        current.push_back(sourceCurrent);
+    }
+};
+
+// Adds the images of every source reflected on the walls of the rectangular window,
+// mirroringDimension times in each direction, as done by the method of images for high permeability walls
+FieldSources add_mirrored_sources(const FieldSources& sources, double windowMinimumX, double windowMaximumX, double windowMinimumY, double windowMaximumY, size_t mirroringDimension);
+
+enum class FieldKernelInstructionSet : int {
+    SCALAR,
+    AVX2,
+    AVX512
+};
+
+// Widest instruction set the running CPU supports, detected once
+FieldKernelInstructionSet get_field_kernel_instruction_set();
+
+// Sums the field strength created by all sources at each point,
+// I / (2 pi r) outside a conductor and I r / (2 pi R^2) inside it
+void calculate_magnetic_field_strength_scalar(const FieldSources& sources, const double* pointsX, const double* pointsY, size_t numberPoints, double* fieldX, double* fieldY);
+
+// Threads worth using for this many point-source interactions, at most maximumNumberThreads (0 for every core)
+size_t get_field_kernel_number_threads(size_t numberInteractions, size_t maximumNumberThreads);
+
+// Same sum, vectorized with the given instruction set. With a pool, the points are split across its workers
+// and the calling thread waits for them, so it must not be one of those workers
+void calculate_magnetic_field_strength(const FieldSources& sources, const double* pointsX, const double* pointsY, size_t numberPoints, double* fieldX, double* fieldY, FieldKernelInstructionSet instructionSet, ThreadPool* pool = nullptr);
+
+// Widest instruction set, on the calling thread only
+void calculate_magnetic_field_strength(const FieldSources& sources, const double* pointsX, const double* pointsY, size_t numberPoints, double* fieldX, double* fieldY);
+
+} // namespace MKFNetInternal
@@ -0,0 +1,188 @@
+#include "JobSystem.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+namespace MKFNetInternal {
+
+namespace {
+    std::atomic<int> nextJobId = 0;
+}
+
+JobSystem::JobSystem(size_t numberWorkers, size_t queueCapacity) : _queueCapacity(std::max(size_t(1), queueCapacity)) {
+    if (numberWorkers == 0) {
+        numberWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t workerIndex = 0; workerIndex < numberWorkers; workerIndex++) {
+        _workers.emplace_back([this] { run_worker(); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    std::deque<std::shared_ptr<Job>> cancelledJobs;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+        cancelledJobs.swap(_queue);
+    }
+    _jobAvailable.notify_all();
+    for (auto& job : cancelledJobs) {
+        finish(job, JobStatus::CANCELLED, "");
+    }
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::run_worker() {
+    ThreadPool::mark_worker_thread();
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _jobAvailable.wait(lock, [this] { return _stopping || !_queue.empty(); });
+            if (_queue.empty()) {
+                return;
+            }
+            job = _queue.front();
+            _queue.pop_front();
+            job->status = JobStatus::RUNNING;
+        }
+
+        JobStatus status = JobStatus::COMPLETED;
+        std::string result;
+        try {
+            result = job->work();
+        }
+        catch (const std::exception &exc) {
+            status = JobStatus::FAILED;
+            result = exc.what();
+        }
+        catch (...) {
+            status = JobStatus::FAILED;
+            result = "Unknown error";
+        }
+        finish(job, status, std::move(result));
+    }
+}
+
+void JobSystem::finish(const std::shared_ptr<Job>& job, JobStatus status, std::string result) {
+    CompletionCallback completionCallback;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (job->cancelRequested) {
+            status = JobStatus::CANCELLED;
+            result.clear();
+        }
+        job->status = status;
+        job->result = std::move(result);
+        job->work = nullptr;
+        completionCallback = _completionCallback;
+    }
+    _jobFinished.notify_all();
+    if (completionCallback) {
+        completionCallback(job->id, job->status, job->result);
+    }
+}
+
+std::optional<int> JobSystem::submit(std::function<std::string()> work) {
+    int jobId;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stopping || _queue.size() >= _queueCapacity) {
+            return std::nullopt;
+        }
+        auto job = std::make_shared<Job>();
+        job->id = jobId = nextJobId++;
+        job->work = std::move(work);
+        _jobs[jobId] = job;
+        _queue.push_back(job);
+    }
+    _jobAvailable.notify_one();
+    return jobId;
+}
+
+std::pair<JobStatus, std::string> JobSystem::poll(int jobId) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto jobIterator = _jobs.find(jobId);
+    if (jobIterator == _jobs.end()) {
+        throw std::invalid_argument("No job with id " + std::to_string(jobId));
+    }
+    return {jobIterator->second->status, jobIterator->second->result};
+}
+
+std::pair<JobStatus, std::string> JobSystem::wait(int jobId, std::optional<std::chrono::milliseconds> timeout) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto jobIterator = _jobs.find(jobId);
+    if (jobIterator == _jobs.end()) {
+        throw std::invalid_argument("No job with id " + std::to_string(jobId));
+    }
+    auto job = jobIterator->second;
+    auto finished = [&job] { return job->status != JobStatus::QUEUED && job->status != JobStatus::RUNNING; };
+    if (timeout) {
+        _jobFinished.wait_for(lock, timeout.value(), finished);
+    }
+    else {
+        _jobFinished.wait(lock, finished);
+    }
+    return {job->status, job->result};
+}
+
+bool JobSystem::cancel(int jobId) {
+    std::shared_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto jobIterator = _jobs.find(jobId);
+        if (jobIterator == _jobs.end()) {
+            return false;
+        }
+        job = jobIterator->second;
+        if (job->status == JobStatus::RUNNING) {
+            job->cancelRequested = true;
+            return true;
+        }
+        if (job->status != JobStatus::QUEUED) {
+            return false;
+        }
+        _queue.erase(std::find(_queue.begin(), _queue.end(), job));
+        job->cancelRequested = true;
+    }
+    finish(job, JobStatus::CANCELLED, "");
+    return true;
+}
+
+bool JobSystem::release(int jobId) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto jobIterator = _jobs.find(jobId);
+    if (jobIterator == _jobs.end() || jobIterator->second->status == JobStatus::QUEUED || jobIterator->second->status == JobStatus::RUNNING) {
+        return false;
+    }
+    _jobs.erase(jobIterator);
+    return true;
+}
+
+void JobSystem::set_completion_callback(CompletionCallback completionCallback) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _completionCallback = std::move(completionCallback);
+}
+
+std::pair<size_t, size_t> JobSystem::get_retained_results() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t numberJobs = 0;
+    size_t resultBytes = 0;
+    for (auto& [jobId, job] : _jobs) {
+        if (job->status != JobStatus::QUEUED && job->status != JobStatus::RUNNING) {
+            numberJobs++;
+            resultBytes += job->result.capacity();
+        }
+    }
+    return {numberJobs, resultBytes};
+}
+
+size_t JobSystem::get_number_jobs() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _jobs.size();
+}
+
+} // namespace MKFNetInternal
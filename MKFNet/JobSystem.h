@@ -0,0 +1,87 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace MKFNetInternal {
+
+enum class JobStatus {
+    QUEUED,
+    RUNNING,
+    COMPLETED,
+    FAILED,
+    CANCELLED
+};
+
+// Fixed set of workers fed from a bounded queue. Jobs produce a string, or fail by throwing,
+// and keep their result until released, so callers can poll or wait from any thread.
+// Job ids are unique across every job system of the process, so an id never names two jobs
+class JobSystem {
+    public:
+        using CompletionCallback = std::function<void(int, JobStatus, const std::string&)>;
+
+    private:
+        struct Job {
+            int id;
+            std::function<std::string()> work;
+            JobStatus status = JobStatus::QUEUED;
+            std::string result;
+            bool cancelRequested = false;
+        };
+
+        std::vector<std::thread> _workers;
+        std::deque<std::shared_ptr<Job>> _queue;
+        std::map<int, std::shared_ptr<Job>> _jobs;
+        size_t _queueCapacity;
+        bool _stopping = false;
+        CompletionCallback _completionCallback;
+        std::mutex _mutex;
+        std::condition_variable _jobAvailable;
+        std::condition_variable _jobFinished;
+
+        void run_worker();
+        void finish(const std::shared_ptr<Job>& job, JobStatus status, std::string result);
+
+    public:
+        JobSystem(size_t numberWorkers = 0, size_t queueCapacity = 256);
+        // Queued jobs are cancelled, running ones are waited for
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // Empty when the queue is full, so callers can push back instead of piling up work
+        std::optional<int> submit(std::function<std::string()> work);
+
+        // Status and result of the job; throws for unknown or released ids
+        std::pair<JobStatus, std::string> poll(int jobId);
+        std::pair<JobStatus, std::string> wait(int jobId, std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+
+        // Queued jobs never run; running jobs cannot be interrupted, so their result is discarded when they finish
+        bool cancel(int jobId);
+        bool release(int jobId);
+
+        // Called on the worker thread once a job reaches a final status
+        void set_completion_callback(CompletionCallback completionCallback);
+
+        // Number of finished jobs not yet released and the bytes of the results they keep
+        std::pair<size_t, size_t> get_retained_results();
+
+        // Jobs submitted and not yet released, whatever their status
+        size_t get_number_jobs();
+
+        size_t get_number_workers() const {
+            return _workers.size();
+        }
+};
+
+} // namespace MKFNetInternal
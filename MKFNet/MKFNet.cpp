@@ -24,72 +24,171 @@
 #include "Utils.h"
 #include "Settings.h"
 #include "Painter.h"
+#include "ThreadPool.h"
+#include "FieldKernel.h"
+#include "TurnTable.h"
+#include "WireGeometry.h"
+#include "SkinEffectTable.h"
+#include "CoreMaterialCache.h"
+#include "MagneticOptimizer.h"
+#include "CatalogSnapshot.h"
+#include "JobSystem.h"
+#include "MasStore.h"
+#include "Metrics.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <numbers>
+#include <numeric>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+#include <tuple>
 #include <vector>
+#ifdef MKFNET_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
 MKFNet::MKFNet(){
 }
 
-std::map<std::string, OpenMagnetics::MasWrapper> masDatabase;
+std::map<std::string, MKFNetInternal::StoredMas> masDatabase;
+std::map<std::string, OpenMagnetics::CoreWrapper> coreDatabase;
+std::mutex painterMutex;
+std::map<std::string, std::shared_ptr<const MKFNetInternal::TurnTable>> turnTableDatabase;
+std::map<std::tuple<std::string, size_t, std::vector<double>>, OpenMagnetics::SignalDescriptor> magnetizingCurrentDatabase;
+
+// Simulated design kept as the base of later delta simulations, together with the JSON document patches apply to
+struct SimulationRecord {
+    json document;
+    std::string modelsString;
+    OpenMagnetics::MasWrapper mas;
+};
+std::map<std::string, SimulationRecord> simulationDatabase;
+
+// Last steady state temperature found for each stored magnetic, operating point index and models, the starting point
+// when the same problem is solved again
+std::map<std::tuple<std::string, size_t, std::string>, double> steadyStateTemperatureDatabase;
+
+// Temperature rise of the last steady state found for each stored magnetic and models at any operating point,
+// the starting point of the next point of a sweep
+std::map<std::pair<std::string, std::string>, double> steadyStateTemperatureRiseDatabase;
+
+// Guards masDatabase and the caches derived from it, as job workers read them while the caller may be loading new keys,
+// and the core and coil handles, which are edited in place and so are held exclusively while in use
+std::shared_mutex databasesMutex;
+
+// Held shared by every job and exclusively by the calls that change the global settings, among them the core adviser,
+// which changes them for as long as it runs
+std::shared_mutex settingsMutex;
+
+// Drops every result derived from a stored magnetic, so that loading a key again does not serve stale data.
+// Callers hold databasesMutex exclusively
+void invalidateDerivedData(const std::string& key) {
+    turnTableDatabase.erase(key);
+    std::erase_if(magnetizingCurrentDatabase, [&key](const auto& entry) { return std::get<0>(entry.first) == key; });
+    simulationDatabase.erase(key);
+    std::erase_if(steadyStateTemperatureDatabase, [&key](const auto& entry) { return std::get<0>(entry.first) == key; });
+    std::erase_if(steadyStateTemperatureRiseDatabase, [&key](const auto& entry) { return entry.first.first == key; });
+}
+
+// Text conversions, timed as stages of whichever entry point runs them
+json parseJson(const std::string& text) {
+    MKFNET_SCOPED_TIMER("parseJson");
+    return json::parse(text);
+}
+
+std::string dumpJson(const json& document) {
+    MKFNET_SCOPED_TIMER("dumpJson");
+    return document.dump(4);
+}
+
+MKFNetInternal::StoredMas getStoredMas(const std::string& key) {
+    std::shared_lock<std::shared_mutex> lock(databasesMutex);
+    auto masIterator = masDatabase.find(key);
+    if (masIterator == masDatabase.end()) {
+        throw std::invalid_argument("No magnetic loaded with key " + key);
+    }
+    return masIterator->second;
+}
+
+// Tables built from the previous catalogs would keep answering for materials and wires that changed
+void clearCatalogCaches() {
+    MKFNetInternal::CoreMaterialCache::get_instance().clear();
+    MKFNetInternal::SkinEffectTableCache::get_instance().clear();
+}
 
 void MKFNet::LoadDatabases(std::string databasesString) {
-    json databasesJson = json::parse(databasesString);
+    MKFNET_SCOPED_TIMER("LoadDatabases");
+    json databasesJson = parseJson(databasesString);
     OpenMagnetics::load_databases(databasesJson, true);
+    clearCatalogCaches();
 }
 
-std::string MKFNet::ReadDatabases(std::string path, bool addInternalData) {
-    try {
-        auto masPath = std::filesystem::path{path};
-        json data;
-        std::string line;
-        {
-            data["coreMaterials"] = json();
-            std::ifstream coreMaterials(masPath.append("core_materials.ndjson"));
-            while (getline (coreMaterials, line)) {
-                json jf = json::parse(line);
-                data["coreMaterials"][jf["name"]] = jf;
-            }
-        }
-        {
-            data["coreShapes"] = json();
-            std::ifstream coreMaterials(masPath.append("core_shapes.ndjson"));
-            while (getline (coreMaterials, line)) {
-                json jf = json::parse(line);
-                data["coreShapes"][jf["name"]] = jf;
-            }
-        }
-        {
-            data["wires"] = json();
-            std::ifstream coreMaterials(masPath.append("wires.ndjson"));
-            while (getline (coreMaterials, line)) {
-                json jf = json::parse(line);
-                data["wires"][jf["name"]] = jf;
-            }
-        }
-        {
-            data["bobbins"] = json();
-            std::ifstream coreMaterials(masPath.append("bobbins.ndjson"));
-            while (getline (coreMaterials, line)) {
-                json jf = json::parse(line);
-                data["bobbins"][jf["name"]] = jf;
-            }
-        }
-        {
-            data["insulationMaterials"] = json();
-            std::ifstream coreMaterials(masPath.append("insulation_materials.ndjson"));
-            while (getline (coreMaterials, line)) {
-                json jf = json::parse(line);
-                data["insulationMaterials"][jf["name"]] = jf;
-            }
+// Catalogs of a MAS data directory, one NDJSON file per catalog, in the layout load_databases takes
+json readMasCatalogs(const std::filesystem::path& masPath) {
+    static const std::vector<std::pair<std::string, std::string>> catalogFiles = {
+        {"coreMaterials", "core_materials.ndjson"},
+        {"coreShapes", "core_shapes.ndjson"},
+        {"wires", "wires.ndjson"},
+        {"bobbins", "bobbins.ndjson"},
+        {"insulationMaterials", "insulation_materials.ndjson"},
+        {"wireMaterials", "wire_materials.ndjson"},
+    };
+    json data;
+    std::string line;
+    for (auto& [catalogName, fileName] : catalogFiles) {
+        data[catalogName] = json();
+        // A missing catalog would otherwise load as an empty one and only show up as lookups failing later
+        std::ifstream catalogFile(masPath / fileName);
+        if (!catalogFile) {
+            throw std::runtime_error("Cannot open catalog " + (masPath / fileName).string());
         }
-        {
-            data["wireMaterials"] = json();
-            std::ifstream coreMaterials(masPath.append("wire_materials.ndjson"));
-            while (getline (coreMaterials, line)) {
-                json jf = json::parse(line);
-                data["wireMaterials"][jf["name"]] = jf;
-            }
+        while (getline (catalogFile, line)) {
+            json jf = parseJson(line);
+            data[catalogName][jf["name"]] = jf;
         }
+    }
+    return data;
+}
+
+std::string MKFNet::ReadDatabases(std::string path, bool addInternalData) {
+    MKFNET_SCOPED_TIMER("ReadDatabases");
+    try {
+        auto data = readMasCatalogs(std::filesystem::path{path});
         OpenMagnetics::load_databases(data, true, addInternalData);
+        clearCatalogCaches();
+        return "0";
+    }
+    catch (const std::exception &exc) {
+        return std::string{exc.what()};
+    }
+}
+
+std::string MKFNet::WriteCatalogSnapshot(std::string path, std::string snapshotPath) {
+    MKFNET_SCOPED_TIMER("WriteCatalogSnapshot");
+    try {
+        MKFNetInternal::write_catalog_snapshot(readMasCatalogs(std::filesystem::path{path}), std::filesystem::path{snapshotPath});
+        return "0";
+    }
+    catch (const std::exception &exc) {
+        return std::string{exc.what()};
+    }
+}
+
+std::string MKFNet::ReadCatalogSnapshot(std::string snapshotPath, bool addInternalData) {
+    MKFNET_SCOPED_TIMER("ReadCatalogSnapshot");
+    try {
+        OpenMagnetics::load_databases(MKFNetInternal::read_catalog_snapshot(std::filesystem::path{snapshotPath}), true, addInternalData);
+        clearCatalogCaches();
         return "0";
     }
     catch (const std::exception &exc) {
@@ -98,6 +197,7 @@ std::string MKFNet::ReadDatabases(std::string path, bool addInternalData) {
 }
 
 OpenMagnetics::MagneticWrapper expandMagnetic(OpenMagnetics::MagneticWrapper magnetic) {
+    MKFNET_SCOPED_TIMER("expandMagnetic");
     auto core = magnetic.get_core();
     auto coil = magnetic.get_coil();
     auto coreMaterial = core.resolve_material();
@@ -216,13 +316,17 @@ OpenMagnetics::MagneticWrapper expandMagnetic(OpenMagnetics::MagneticWrapper mag
 }
 
 std::string MKFNet::LoadMas(std::string key, std::string masString, bool expand) {
+    MKFNET_SCOPED_TIMER("LoadMas");
     try {
-        json masJson = json::parse(masString);
+        json masJson = parseJson(masString);
         OpenMagnetics::MasWrapper mas(masJson);
         if (expand) {
             mas.get_mutable_magnetic() = expandMagnetic(mas.get_mutable_magnetic());
         }
-        masDatabase[key] = mas;
+        MKFNetInternal::StoredMas storedMas(mas);
+        std::unique_lock<std::shared_mutex> lock(databasesMutex);
+        masDatabase.insert_or_assign(key, std::move(storedMas));
+        invalidateDerivedData(key);
         return std::to_string(masDatabase.size());
     }
     catch (const std::exception &exc) {
@@ -231,16 +335,17 @@ std::string MKFNet::LoadMas(std::string key, std::string masString, bool expand)
 }
 
 std::string MKFNet::LoadMagnetic(std::string key, std::string magneticString, std::string inputsString, bool expand) {
+    MKFNET_SCOPED_TIMER("LoadMagnetic");
     try {
-        OpenMagnetics::MagneticWrapper magnetic(json::parse(magneticString));
-        OpenMagnetics::InputsWrapper inputs(json::parse(inputsString));
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
+        OpenMagnetics::InputsWrapper inputs(parseJson(inputsString));
         if (expand) {
             magnetic = expandMagnetic(magnetic);
         }
-        OpenMagnetics::MasWrapper mas;
-        mas.set_magnetic(magnetic);
-        mas.set_inputs(inputs);
-        masDatabase[key] = mas;
+        MKFNetInternal::StoredMas storedMas(magnetic, MKFNetInternal::intern_inputs(inputs));
+        std::unique_lock<std::shared_mutex> lock(databasesMutex);
+        masDatabase.insert_or_assign(key, std::move(storedMas));
+        invalidateDerivedData(key);
         return std::to_string(masDatabase.size());
     }
     catch (const std::exception &exc) {
@@ -250,20 +355,23 @@ std::string MKFNet::LoadMagnetic(std::string key, std::string magneticString, st
 
 
 std::string MKFNet::LoadMagnetics(std::string keys, std::string magneticsString, std::string inputsString, bool expand) {
+    MKFNET_SCOPED_TIMER("LoadMagnetics");
     try {
-        json magneticJsons = json::parse(magneticsString);
-        json keysJson = json::parse(keys);
-        OpenMagnetics::InputsWrapper inputs(json::parse(inputsString));
+        json magneticJsons = parseJson(magneticsString);
+        json keysJson = parseJson(keys);
+        // Every magnetic of the call shares one copy of the inputs
+        auto inputs = MKFNetInternal::intern_inputs(OpenMagnetics::InputsWrapper(parseJson(inputsString)));
         for (size_t magneticIndex = 0; magneticIndex < magneticJsons.size(); magneticIndex++) {
             OpenMagnetics::MagneticWrapper magnetic(magneticJsons[magneticIndex]);
             if (expand) {
                 magnetic = expandMagnetic(magnetic);
             }
-            OpenMagnetics::MasWrapper mas;
-            mas.set_magnetic(magnetic);
-            mas.set_inputs(inputs);
-            masDatabase[keysJson[magneticIndex]] = mas;
+            MKFNetInternal::StoredMas storedMas(magnetic, inputs);
+            std::unique_lock<std::shared_mutex> lock(databasesMutex);
+            masDatabase.insert_or_assign(keysJson[magneticIndex].get<std::string>(), std::move(storedMas));
+            invalidateDerivedData(keysJson[magneticIndex].get<std::string>());
         }
+        std::shared_lock<std::shared_mutex> lock(databasesMutex);
         return std::to_string(masDatabase.size());
     }
     catch (const std::exception &exc) {
@@ -272,11 +380,12 @@ std::string MKFNet::LoadMagnetics(std::string keys, std::string magneticsString,
 }
 
 std::string MKFNet::LoadMagneticsFromFile(std::string path, std::string inputsString, bool expand) {
+    MKFNET_SCOPED_TIMER("LoadMagneticsFromFile");
     try {
         std::ifstream in(path);
         std::vector<std::vector<double>> fields;
         size_t number_read_rows = 0;
-        OpenMagnetics::InputsWrapper inputs(json::parse(inputsString));
+        auto inputs = MKFNetInternal::intern_inputs(OpenMagnetics::InputsWrapper(parseJson(inputsString)));
 
         if (in) {
             std::string line;
@@ -291,7 +400,7 @@ std::string MKFNet::LoadMagneticsFromFile(std::string path, std::string inputsSt
                     row_data.push_back(field);
                 }
 
-                OpenMagnetics::MagneticWrapper magnetic(json::parse(row_data[1]));
+                OpenMagnetics::MagneticWrapper magnetic(parseJson(row_data[1]));
                 OpenMagnetics::MagneticManufacturerInfo manufacturerInfo;
                 manufacturerInfo.set_name("Wuerth Elektronik");
                 manufacturerInfo.set_reference(row_data[0]);
@@ -299,12 +408,13 @@ std::string MKFNet::LoadMagneticsFromFile(std::string path, std::string inputsSt
                 if (expand) {
                     magnetic = expandMagnetic(magnetic);
                 }
-                OpenMagnetics::MasWrapper mas;
-                mas.set_magnetic(magnetic);
-                mas.set_inputs(inputs);
-                masDatabase[row_data[0]] = mas;
+                MKFNetInternal::StoredMas storedMas(magnetic, inputs);
+                std::unique_lock<std::shared_mutex> lock(databasesMutex);
+                masDatabase.insert_or_assign(row_data[0], std::move(storedMas));
+                invalidateDerivedData(row_data[0]);
             }
         }
+        std::shared_lock<std::shared_mutex> lock(databasesMutex);
         return std::to_string(masDatabase.size());
     }
     catch (const std::exception &exc) {
@@ -315,12 +425,19 @@ std::string MKFNet::LoadMagneticsFromFile(std::string path, std::string inputsSt
 }
 
 std::string MKFNet::ReadMas(std::string key) {
-    json result;
-    to_json(result, masDatabase[key]);
-    return result.dump(4);
+    MKFNET_SCOPED_TIMER("ReadMas");
+    try {
+        json result;
+        to_json(result, getStoredMas(key).get_mas());
+        return dumpJson(result);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
 }
 
 std::string MKFNet::GetCoreMaterials() {
+    MKFNET_SCOPED_TIMER("GetCoreMaterials");
     try {
         auto materials = OpenMagnetics::get_materials(std::nullopt);
         json result = json::array();
@@ -329,13 +446,14 @@ std::string MKFNet::GetCoreMaterials() {
             OpenMagnetics::to_json(aux, elem);
             result.push_back(aux);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
     }
 }
 std::string MKFNet::GetCoreShapes() {
+    MKFNET_SCOPED_TIMER("GetCoreShapes");
     try {
         auto shapes = OpenMagnetics::get_shapes(true);
         json result = json::array();
@@ -344,13 +462,14 @@ std::string MKFNet::GetCoreShapes() {
             OpenMagnetics::to_json(aux, elem);
             result.push_back(aux);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
     }
 }
 std::string MKFNet::GetWires() {
+    MKFNET_SCOPED_TIMER("GetWires");
     try {
         auto wires = OpenMagnetics::get_wires();
         json result = json::array();
@@ -359,13 +478,14 @@ std::string MKFNet::GetWires() {
             OpenMagnetics::to_json(aux, elem);
             result.push_back(aux);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
     }
 }
 std::string MKFNet::GetBobbins() {
+    MKFNET_SCOPED_TIMER("GetBobbins");
     try {
         auto bobbins = OpenMagnetics::get_bobbins();
         json result = json::array();
@@ -374,13 +494,14 @@ std::string MKFNet::GetBobbins() {
             OpenMagnetics::to_json(aux, elem);
             result.push_back(aux);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
     }
 }
 std::string MKFNet::GetInsulationMaterials() {
+    MKFNET_SCOPED_TIMER("GetInsulationMaterials");
     try {
         auto insulationMaterials = OpenMagnetics::get_insulation_materials();
         json result = json::array();
@@ -389,13 +510,14 @@ std::string MKFNet::GetInsulationMaterials() {
             OpenMagnetics::to_json(aux, elem);
             result.push_back(aux);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
     }
 }
 std::string MKFNet::GetWireMaterials() {
+    MKFNET_SCOPED_TIMER("GetWireMaterials");
     try {
         auto wireMaterials = OpenMagnetics::get_wire_materials();
         json result = json::array();
@@ -404,7 +526,7 @@ std::string MKFNet::GetWireMaterials() {
             OpenMagnetics::to_json(aux, elem);
             result.push_back(aux);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -412,13 +534,14 @@ std::string MKFNet::GetWireMaterials() {
 }
 
 std::string MKFNet::GetCoreMaterialNames() {
+    MKFNET_SCOPED_TIMER("GetCoreMaterialNames");
     try {
         auto materialNames = OpenMagnetics::get_material_names(std::nullopt);
         json result = json::array();
         for (auto elem : materialNames) {
             result.push_back(elem);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -426,13 +549,14 @@ std::string MKFNet::GetCoreMaterialNames() {
 }
 
 std::string MKFNet::GetCoreShapeNames() {
+    MKFNET_SCOPED_TIMER("GetCoreShapeNames");
     try {
         auto shapeNames = OpenMagnetics::get_shape_names();
         json result = json::array();
         for (auto elem : shapeNames) {
             result.push_back(elem);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -440,13 +564,14 @@ std::string MKFNet::GetCoreShapeNames() {
 }
 
 std::string MKFNet::GetWireNames() {
+    MKFNET_SCOPED_TIMER("GetWireNames");
     try {
         auto wireNames = OpenMagnetics::get_wire_names();
         json result = json::array();
         for (auto elem : wireNames) {
             result.push_back(elem);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -454,13 +579,14 @@ std::string MKFNet::GetWireNames() {
 }
 
 std::string MKFNet::GetBobbinNames() {
+    MKFNET_SCOPED_TIMER("GetBobbinNames");
     try {
         auto bobbinNames = OpenMagnetics::get_bobbin_names();
         json result = json::array();
         for (auto elem : bobbinNames) {
             result.push_back(elem);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -468,13 +594,14 @@ std::string MKFNet::GetBobbinNames() {
 }
 
 std::string MKFNet::GetInsulationMaterialNames() {
+    MKFNET_SCOPED_TIMER("GetInsulationMaterialNames");
     try {
         auto insulationMaterialNames = OpenMagnetics::get_insulation_material_names();
         json result = json::array();
         for (auto elem : insulationMaterialNames) {
             result.push_back(elem);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -482,13 +609,14 @@ std::string MKFNet::GetInsulationMaterialNames() {
 }
 
 std::string MKFNet::GetWireMaterialNames() {
+    MKFNET_SCOPED_TIMER("GetWireMaterialNames");
     try {
         auto wireMaterialNames = OpenMagnetics::get_wire_material_names();
         json result = json::array();
         for (auto elem : wireMaterialNames) {
             result.push_back(elem);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -496,11 +624,12 @@ std::string MKFNet::GetWireMaterialNames() {
 }
 
 std::string MKFNet::FindCoreMaterialByName(std::string materialName) {
+    MKFNET_SCOPED_TIMER("FindCoreMaterialByName");
     try {
         auto materialData = OpenMagnetics::find_core_material_by_name(materialName);
         json result;
         to_json(result, materialData);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -508,11 +637,12 @@ std::string MKFNet::FindCoreMaterialByName(std::string materialName) {
 }
 
 std::string MKFNet::FindCoreShapeByName(std::string shapeName) {
+    MKFNET_SCOPED_TIMER("FindCoreShapeByName");
     try {
         auto shapeData = OpenMagnetics::find_core_shape_by_name(shapeName);
         json result;
         to_json(result, shapeData);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -520,11 +650,12 @@ std::string MKFNet::FindCoreShapeByName(std::string shapeName) {
 }
 
 std::string MKFNet::FindWireByName(std::string wireName) {
+    MKFNET_SCOPED_TIMER("FindWireByName");
     try {
         auto wireData = OpenMagnetics::find_wire_by_name(wireName);
         json result;
         to_json(result, wireData);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -532,11 +663,12 @@ std::string MKFNet::FindWireByName(std::string wireName) {
 }
 
 std::string MKFNet::FindBobbinByName(std::string bobbinName) {
+    MKFNET_SCOPED_TIMER("FindBobbinByName");
     try {
         auto bobbinData = OpenMagnetics::find_bobbin_by_name(bobbinName);
         json result;
         to_json(result, bobbinData);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -544,11 +676,12 @@ std::string MKFNet::FindBobbinByName(std::string bobbinName) {
 }
 
 std::string MKFNet::FindInsulationMaterialByName(std::string insulationMaterialName) {
+    MKFNET_SCOPED_TIMER("FindInsulationMaterialByName");
     try {
         auto insulationMaterialData = OpenMagnetics::find_insulation_material_by_name(insulationMaterialName);
         json result;
         to_json(result, insulationMaterialData);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -556,23 +689,88 @@ std::string MKFNet::FindInsulationMaterialByName(std::string insulationMaterialN
 }
 
 std::string MKFNet::FindWireMaterialByName(std::string wireMaterialName) {
+    MKFNET_SCOPED_TIMER("FindWireMaterialByName");
     try {
         auto wireMaterialData = OpenMagnetics::find_wire_material_by_name(wireMaterialName);
         json result;
         to_json(result, wireMaterialData);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
     }
 }
 
+// Callers hold databasesMutex exclusively for as long as they use the handle
+OpenMagnetics::CoreWrapper& getCoreHandle(std::string key) {
+    auto coreIterator = coreDatabase.find(key);
+    if (coreIterator == coreDatabase.end()) {
+        throw std::runtime_error("No core loaded with key: " + key);
+    }
+    return coreIterator->second;
+}
+
+void processCoreHandleData(OpenMagnetics::CoreWrapper& core) {
+    if (!core.get_processed_description()) {
+        core.process_data();
+    }
+}
+
+void processCoreHandleGapping(OpenMagnetics::CoreWrapper& core) {
+    processCoreHandleData(core);
+    if (core.get_functional_description().get_gapping().size() > 0 && !core.get_functional_description().get_gapping()[0].get_area()) {
+        core.process_gap();
+    }
+}
+
+void processCoreHandleGeometricalDescription(OpenMagnetics::CoreWrapper& core) {
+    processCoreHandleGapping(core);
+    if (!core.get_geometrical_description()) {
+        auto geometricalDescription = core.create_geometrical_description();
+        core.set_geometrical_description(geometricalDescription);
+    }
+}
+
+std::string MKFNet::LoadCore(std::string key, std::string coreDataString, bool includeMaterialData) {
+    MKFNET_SCOPED_TIMER("LoadCore");
+    try {
+        OpenMagnetics::CoreWrapper core(parseJson(coreDataString), includeMaterialData, false, false);
+        std::unique_lock<std::shared_mutex> lock(databasesMutex);
+        coreDatabase[key] = core;
+        return std::to_string(coreDatabase.size());
+    }
+    catch (const std::exception &exc) {
+        return std::string{exc.what()};
+    }
+}
+
+bool MKFNet::UnloadCore(std::string key) {
+    MKFNET_SCOPED_TIMER("UnloadCore");
+    std::unique_lock<std::shared_mutex> lock(databasesMutex);
+    return coreDatabase.erase(key) > 0;
+}
+
 std::string MKFNet::CalculateCoreData(std::string coreDataString, bool includeMaterialData){
+    MKFNET_SCOPED_TIMER("CalculateCoreData");
     try {
-        OpenMagnetics::CoreWrapper core(json::parse(coreDataString), includeMaterialData);
         json result;
-        to_json(result, core);
-        return result.dump(4);
+        if (coreDataString.starts_with("{")) {
+            OpenMagnetics::CoreWrapper core(parseJson(coreDataString), includeMaterialData);
+            to_json(result, core);
+        }
+        else {
+            std::unique_lock<std::shared_mutex> lock(databasesMutex);
+            auto& coreHandle = getCoreHandle(coreDataString);
+            processCoreHandleGeometricalDescription(coreHandle);
+            // The material is resolved into the response only, so the handle keeps naming it as it was loaded
+            auto core = coreHandle;
+            if (includeMaterialData && std::holds_alternative<std::string>(core.get_functional_description().get_material())) {
+                auto coreMaterial = core.resolve_material();
+                core.get_mutable_functional_description().set_material(coreMaterial);
+            }
+            to_json(result, core);
+        }
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -580,12 +778,21 @@ std::string MKFNet::CalculateCoreData(std::string coreDataString, bool includeMa
 }
 
 std::string MKFNet::CalculateCoreProcessedDescription(std::string coreDataString){
+    MKFNET_SCOPED_TIMER("CalculateCoreProcessedDescription");
     try {
-        OpenMagnetics::CoreWrapper core(json::parse(coreDataString), false, false, false);
-        core.process_data();
         json result;
-        to_json(result, core.get_processed_description().value());
-        return result.dump(4);
+        if (coreDataString.starts_with("{")) {
+            OpenMagnetics::CoreWrapper core(parseJson(coreDataString), false, false, false);
+            core.process_data();
+            to_json(result, core.get_processed_description().value());
+        }
+        else {
+            std::unique_lock<std::shared_mutex> lock(databasesMutex);
+            auto& core = getCoreHandle(coreDataString);
+            processCoreHandleData(core);
+            to_json(result, core.get_processed_description().value());
+        }
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -593,16 +800,26 @@ std::string MKFNet::CalculateCoreProcessedDescription(std::string coreDataString
 }
 
 std::string MKFNet::CalculateCoreGeometricalDescription(std::string coreDataString){
+    MKFNET_SCOPED_TIMER("CalculateCoreGeometricalDescription");
     try {
-        OpenMagnetics::CoreWrapper core(json::parse(coreDataString), false, false, false);
-        auto geometricalDescription = core.create_geometrical_description().value();
+        std::vector<OpenMagnetics::CoreGeometricalDescriptionElement> geometricalDescription;
+        if (coreDataString.starts_with("{")) {
+            OpenMagnetics::CoreWrapper core(parseJson(coreDataString), false, false, false);
+            geometricalDescription = core.create_geometrical_description().value();
+        }
+        else {
+            std::unique_lock<std::shared_mutex> lock(databasesMutex);
+            auto& core = getCoreHandle(coreDataString);
+            processCoreHandleGeometricalDescription(core);
+            geometricalDescription = core.get_geometrical_description().value();
+        }
         json result = json::array();
         for (auto& elem : geometricalDescription) {
             json aux;
             to_json(aux, elem);
             result.push_back(aux);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -610,16 +827,27 @@ std::string MKFNet::CalculateCoreGeometricalDescription(std::string coreDataStri
 }
 
 std::string MKFNet::CalculateCoreGapping(std::string coreDataString){
+    MKFNET_SCOPED_TIMER("CalculateCoreGapping");
     try {
-        OpenMagnetics::CoreWrapper core(json::parse(coreDataString), false, false, false);
-        core.process_gap();
+        std::vector<OpenMagnetics::CoreGap> gapping;
+        if (coreDataString.starts_with("{")) {
+            OpenMagnetics::CoreWrapper core(parseJson(coreDataString), false, false, false);
+            core.process_gap();
+            gapping = core.get_functional_description().get_gapping();
+        }
+        else {
+            std::unique_lock<std::shared_mutex> lock(databasesMutex);
+            auto& core = getCoreHandle(coreDataString);
+            processCoreHandleGapping(core);
+            gapping = core.get_functional_description().get_gapping();
+        }
         json result = json::array();
-        for (auto& gap : core.get_functional_description().get_gapping()) {
+        for (auto& gap : gapping) {
             json aux;
             to_json(aux, gap);
             result.push_back(aux);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -627,11 +855,12 @@ std::string MKFNet::CalculateCoreGapping(std::string coreDataString){
 }
 
 std::string MKFNet::Wind(std::string coilString, size_t repetitions, std::string proportionPerWindingString, std::string patternString) {
+    MKFNET_SCOPED_TIMER("Wind");
     try {
-        auto coilJson = json::parse(coilString);
+        auto coilJson = parseJson(coilString);
 
-        std::vector<double> proportionPerWinding = json::parse(proportionPerWindingString);
-        std::vector<size_t> pattern = json::parse(patternString);
+        std::vector<double> proportionPerWinding = parseJson(proportionPerWindingString);
+        std::vector<size_t> pattern = parseJson(patternString);
         auto coilFunctionalDescription = std::vector<OpenMagnetics::CoilFunctionalDescription>(coilJson["functionalDescription"]);
         OpenMagnetics::CoilWrapper coil;
 
@@ -678,7 +907,7 @@ std::string MKFNet::Wind(std::string coilString, size_t repetitions, std::string
 
         json result;
         to_json(result, coil);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -686,11 +915,12 @@ std::string MKFNet::Wind(std::string coilString, size_t repetitions, std::string
 }
 
 std::string MKFNet::WindBySections(std::string coilString, size_t repetitions, std::string proportionPerWindingString, std::string patternString) {
+    MKFNET_SCOPED_TIMER("WindBySections");
     try {
-        auto coilJson = json::parse(coilString);
+        auto coilJson = parseJson(coilString);
 
-        std::vector<double> proportionPerWinding = json::parse(proportionPerWindingString);
-        std::vector<size_t> pattern = json::parse(patternString);
+        std::vector<double> proportionPerWinding = parseJson(proportionPerWindingString);
+        std::vector<size_t> pattern = parseJson(patternString);
         auto coilFunctionalDescription = std::vector<OpenMagnetics::CoilFunctionalDescription>(coilJson["functionalDescription"]);
         OpenMagnetics::CoilWrapper coil;
 
@@ -737,7 +967,7 @@ std::string MKFNet::WindBySections(std::string coilString, size_t repetitions, s
 
         json result;
         to_json(result, coil);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -745,8 +975,9 @@ std::string MKFNet::WindBySections(std::string coilString, size_t repetitions, s
 }
 
 std::string MKFNet::WindByLayers(std::string coilString) {
+    MKFNET_SCOPED_TIMER("WindByLayers");
     try {
-        auto coilJson = json::parse(coilString);
+        auto coilJson = parseJson(coilString);
 
         auto coilFunctionalDescription = std::vector<OpenMagnetics::CoilFunctionalDescription>(coilJson["functionalDescription"]);
         auto coilSectionsDescription = std::vector<OpenMagnetics::Section>(coilJson["sectionsDescription"]);
@@ -775,7 +1006,7 @@ std::string MKFNet::WindByLayers(std::string coilString) {
 
         json result;
         to_json(result, coil);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -783,8 +1014,9 @@ std::string MKFNet::WindByLayers(std::string coilString) {
 }
 
 std::string MKFNet::WindByTurns(std::string coilString) {
+    MKFNET_SCOPED_TIMER("WindByTurns");
     try {
-        auto coilJson = json::parse(coilString);
+        auto coilJson = parseJson(coilString);
 
         auto coilFunctionalDescription = std::vector<OpenMagnetics::CoilFunctionalDescription>(coilJson["functionalDescription"]);
         auto coilSectionsDescription = std::vector<OpenMagnetics::Section>(coilJson["sectionsDescription"]);
@@ -815,7 +1047,7 @@ std::string MKFNet::WindByTurns(std::string coilString) {
 
         json result;
         to_json(result, coil);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -824,8 +1056,9 @@ std::string MKFNet::WindByTurns(std::string coilString) {
 
 
 std::string MKFNet::DelimitAndCompact(std::string coilString) {
+    MKFNET_SCOPED_TIMER("DelimitAndCompact");
     try {
-        auto coilJson = json::parse(coilString);
+        auto coilJson = parseJson(coilString);
 
         auto coilFunctionalDescription = std::vector<OpenMagnetics::CoilFunctionalDescription>(coilJson["functionalDescription"]);
         auto coilSectionsDescription = std::vector<OpenMagnetics::Section>(coilJson["sectionsDescription"]);
@@ -858,7 +1091,213 @@ std::string MKFNet::DelimitAndCompact(std::string coilString) {
 
         json result;
         to_json(result, coil);
-        return result.dump(4);
+        return dumpJson(result);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+enum class CoilStage : int {
+    SECTIONS,
+    LAYERS,
+    TURNS,
+    WOUND
+};
+
+struct CoilHandle {
+    OpenMagnetics::CoilWrapper coil;
+    size_t repetitions = 1;
+    std::vector<double> proportionPerWinding;
+    std::vector<size_t> pattern;
+    CoilStage firstInvalidStage = CoilStage::SECTIONS;
+
+    void invalidate(CoilStage stage) {
+        firstInvalidStage = std::min(firstInvalidStage, stage);
+    }
+};
+
+// A loaded coil with its own mutex, so editing one handle never waits for other handles or for databasesMutex
+struct StoredCoilHandle {
+    std::mutex mutex;
+    CoilHandle coilHandle;
+};
+
+std::map<std::string, std::shared_ptr<StoredCoilHandle>> coilDatabase;
+
+// The handle stays usable after the coil is unloaded or replaced, by whoever still holds it
+std::shared_ptr<StoredCoilHandle> getCoilHandle(std::string key) {
+    std::shared_lock<std::shared_mutex> lock(databasesMutex);
+    auto coilIterator = coilDatabase.find(key);
+    if (coilIterator == coilDatabase.end()) {
+        throw std::runtime_error("No coil loaded with key: " + key);
+    }
+    return coilIterator->second;
+}
+
+void updateCoilHandle(CoilHandle& coilHandle, json coilJson) {
+    auto& coil = coilHandle.coil;
+
+    if (coilJson.contains("_interleavingLevel")) {
+        coil.set_interleaving_level(coilJson["_interleavingLevel"]);
+        coilHandle.invalidate(CoilStage::SECTIONS);
+    }
+    if (coilJson.contains("_windingOrientation")) {
+        coil.set_winding_orientation(coilJson["_windingOrientation"]);
+        coilHandle.invalidate(CoilStage::SECTIONS);
+    }
+    if (coilJson.contains("_sectionAlignment")) {
+        coil.set_section_alignment(coilJson["_sectionAlignment"]);
+        coilHandle.invalidate(CoilStage::SECTIONS);
+    }
+    if (coilJson.contains("_layersOrientation")) {
+        coil.set_layers_orientation(coilJson["_layersOrientation"]);
+        coilHandle.invalidate(CoilStage::LAYERS);
+    }
+    if (coilJson.contains("_turnsAlignment")) {
+        coil.set_turns_alignment(coilJson["_turnsAlignment"]);
+        coilHandle.invalidate(CoilStage::TURNS);
+    }
+    if (coilJson.contains("repetitions")) {
+        coilHandle.repetitions = coilJson["repetitions"];
+        coilHandle.invalidate(CoilStage::SECTIONS);
+    }
+    if (coilJson.contains("proportionPerWinding")) {
+        coilHandle.proportionPerWinding = coilJson["proportionPerWinding"].get<std::vector<double>>();
+        coilHandle.invalidate(CoilStage::SECTIONS);
+    }
+    if (coilJson.contains("pattern")) {
+        coilHandle.pattern = coilJson["pattern"].get<std::vector<size_t>>();
+        coilHandle.invalidate(CoilStage::SECTIONS);
+    }
+    if (coilJson.contains("bobbin")) {
+        coil.set_bobbin(coilJson["bobbin"]);
+        coilHandle.invalidate(CoilStage::SECTIONS);
+    }
+    if (coilJson.contains("functionalDescription")) {
+        coil.set_functional_description(std::vector<OpenMagnetics::CoilFunctionalDescription>(coilJson["functionalDescription"]));
+        coilHandle.invalidate(CoilStage::SECTIONS);
+    }
+
+    // Descriptions given explicitly are kept, and only the stages after them are recomputed
+    if (coilJson.contains("sectionsDescription")) {
+        coil.set_sections_description(std::vector<OpenMagnetics::Section>(coilJson["sectionsDescription"]));
+        coilHandle.firstInvalidStage = CoilStage::LAYERS;
+    }
+    if (coilJson.contains("layersDescription") && coilHandle.firstInvalidStage >= CoilStage::LAYERS) {
+        coil.set_layers_description(std::vector<OpenMagnetics::Layer>(coilJson["layersDescription"]));
+        coilHandle.firstInvalidStage = CoilStage::TURNS;
+    }
+    if (coilJson.contains("turnsDescription") && coilHandle.firstInvalidStage >= CoilStage::TURNS) {
+        coil.set_turns_description(std::vector<OpenMagnetics::Turn>(coilJson["turnsDescription"]));
+        coilHandle.firstInvalidStage = CoilStage::WOUND;
+    }
+}
+
+void windCoilHandle(CoilHandle& coilHandle) {
+    auto& coil = coilHandle.coil;
+    auto settings = OpenMagnetics::Settings::GetInstance();
+    auto& pattern = coilHandle.pattern;
+    auto& proportionPerWinding = coilHandle.proportionPerWinding;
+    auto repetitions = coilHandle.repetitions;
+
+    if (coilHandle.firstInvalidStage <= CoilStage::SECTIONS) {
+        coil.set_sections_description(std::nullopt);
+        coil.set_layers_description(std::nullopt);
+        coil.set_turns_description(std::nullopt);
+        if (proportionPerWinding.size() == coil.get_functional_description().size()) {
+            if (pattern.size() > 0 && repetitions > 0) {
+                coil.wind_by_sections(proportionPerWinding, pattern, repetitions);
+            }
+            else if (repetitions > 0) {
+                coil.wind_by_sections(repetitions);
+            }
+            else {
+                coil.wind_by_sections();
+            }
+        }
+        else {
+            if (pattern.size() > 0 && repetitions > 0) {
+                coil.wind_by_sections(pattern, repetitions);
+            }
+            else if (repetitions > 0) {
+                coil.wind_by_sections(repetitions);
+            }
+            else {
+                coil.wind_by_sections();
+            }
+        }
+    }
+    if (coilHandle.firstInvalidStage <= CoilStage::LAYERS) {
+        coil.set_layers_description(std::nullopt);
+        coil.set_turns_description(std::nullopt);
+        coil.wind_by_layers();
+    }
+    if (coilHandle.firstInvalidStage <= CoilStage::TURNS) {
+        coil.set_turns_description(std::nullopt);
+        coil.wind_by_turns();
+        if (settings->get_coil_delimit_and_compact()) {
+            coil.delimit_and_compact();
+        }
+    }
+    coilHandle.firstInvalidStage = CoilStage::WOUND;
+}
+
+std::string MKFNet::LoadCoil(std::string key, std::string coilString) {
+    MKFNET_SCOPED_TIMER("LoadCoil");
+    try {
+        auto storedCoilHandle = std::make_shared<StoredCoilHandle>();
+        updateCoilHandle(storedCoilHandle->coilHandle, parseJson(coilString));
+        std::unique_lock<std::shared_mutex> lock(databasesMutex);
+        coilDatabase[key] = storedCoilHandle;
+        return std::to_string(coilDatabase.size());
+    }
+    catch (const std::exception &exc) {
+        return std::string{exc.what()};
+    }
+}
+
+bool MKFNet::UnloadCoil(std::string key) {
+    MKFNET_SCOPED_TIMER("UnloadCoil");
+    std::unique_lock<std::shared_mutex> lock(databasesMutex);
+    return coilDatabase.erase(key) > 0;
+}
+
+std::string MKFNet::UpdateCoil(std::string key, std::string coilChangesString) {
+    MKFNET_SCOPED_TIMER("UpdateCoil");
+    try {
+        auto coilChanges = parseJson(coilChangesString);
+        auto storedCoilHandle = getCoilHandle(key);
+        std::lock_guard<std::mutex> lock(storedCoilHandle->mutex);
+        // Changes are applied to a copy, so an edit that fails halfway leaves the handle as it was
+        auto coilHandle = storedCoilHandle->coilHandle;
+        updateCoilHandle(coilHandle, coilChanges);
+        windCoilHandle(coilHandle);
+
+        json result;
+        to_json(result, coilHandle.coil);
+        storedCoilHandle->coilHandle = std::move(coilHandle);
+        return dumpJson(result);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+std::string MKFNet::ReadCoil(std::string key) {
+    MKFNET_SCOPED_TIMER("ReadCoil");
+    try {
+        auto storedCoilHandle = getCoilHandle(key);
+        std::lock_guard<std::mutex> lock(storedCoilHandle->mutex);
+        if (storedCoilHandle->coilHandle.firstInvalidStage != CoilStage::WOUND) {
+            auto coilHandle = storedCoilHandle->coilHandle;
+            windCoilHandle(coilHandle);
+            storedCoilHandle->coilHandle = std::move(coilHandle);
+        }
+
+        json result;
+        to_json(result, storedCoilHandle->coilHandle.coil);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -866,6 +1305,7 @@ std::string MKFNet::DelimitAndCompact(std::string coilString) {
 }
 
 std::string MKFNet::GetDefaultModels() {
+    MKFNET_SCOPED_TIMER("GetDefaultModels");
     try {
         json models;
         auto reluctanceModelName = magic_enum::enum_name(OpenMagnetics::Defaults().reluctanceModelDefault);
@@ -882,40 +1322,151 @@ std::string MKFNet::GetDefaultModels() {
     }
 }
 
+// Magnetizing current seen by the core, as the ampere-turns of every winding referred to the first one.
+// Currents are taken as entering the dotted terminal of their winding, and windingPolarities holds +1 for each winding
+// wound like the first and -1 for each wound the other way. Throws unless every excited winding has a current waveform
+// sampled like the first one, as falling back to the primary current would silently answer a different question
+OpenMagnetics::SignalDescriptor calculateNetMagnetizingCurrent(OpenMagnetics::MagneticWrapper& magnetic, OpenMagnetics::OperatingPoint& operatingPoint, const std::vector<double>& windingPolarities) {
+    auto excitations = operatingPoint.get_excitations_per_winding();
+    auto functionalDescription = magnetic.get_coil().get_functional_description();
+    if (excitations.size() > functionalDescription.size()) {
+        throw std::invalid_argument("Operating point excites " + std::to_string(excitations.size()) + " windings but the coil has " + std::to_string(functionalDescription.size()));
+    }
+
+    double frequency = excitations[0].get_frequency();
+    double primaryNumberTurns = functionalDescription[0].get_number_turns();
+    OpenMagnetics::Waveform netMagnetizingCurrentWaveform;
+    std::vector<double> netMagnetizingCurrentData;
+    for (size_t windingIndex = 0; windingIndex < excitations.size(); windingIndex++) {
+        auto current = excitations[windingIndex].get_current();
+        if (!current || !current->get_waveform()) {
+            throw std::invalid_argument("magnetizingCurrent NET needs a current waveform in every winding, winding " + std::to_string(windingIndex) + " has none");
+        }
+        auto sampledWaveform = OpenMagnetics::InputsWrapper::calculate_sampled_waveform(current->get_waveform().value(), frequency);
+        const auto& samples = sampledWaveform.get_data();
+        if (windingIndex == 0) {
+            netMagnetizingCurrentWaveform = sampledWaveform;
+            netMagnetizingCurrentData.assign(samples.size(), 0);
+        }
+        if (samples.size() != netMagnetizingCurrentData.size()) {
+            throw std::invalid_argument("magnetizingCurrent NET needs windings sampled alike, winding " + std::to_string(windingIndex) + " has " +
+                                        std::to_string(samples.size()) + " samples and the first " + std::to_string(netMagnetizingCurrentData.size()));
+        }
+        double polarity = windingIndex < windingPolarities.size()? windingPolarities[windingIndex] : 1;
+        double turnsRatio = polarity * functionalDescription[windingIndex].get_number_turns() / primaryNumberTurns;
+        std::transform(samples.begin(), samples.end(), netMagnetizingCurrentData.begin(), netMagnetizingCurrentData.begin(), [turnsRatio](double sample, double netSample) {
+            return netSample + turnsRatio * sample;
+        });
+    }
+    netMagnetizingCurrentWaveform.set_data(netMagnetizingCurrentData);
+
+    OpenMagnetics::SignalDescriptor netMagnetizingCurrent;
+    auto harmonics = OpenMagnetics::InputsWrapper::calculate_harmonics_data(netMagnetizingCurrentWaveform, frequency);
+    netMagnetizingCurrent.set_waveform(netMagnetizingCurrentWaveform);
+    netMagnetizingCurrent.set_harmonics(harmonics);
+    netMagnetizingCurrent.set_processed(OpenMagnetics::InputsWrapper::calculate_processed_data(harmonics, netMagnetizingCurrentWaveform, true));
+    return netMagnetizingCurrent;
+}
+
 std::string MKFNet::CalculateCoreLosses(std::string magneticString, std::string inputsString, std::string modelsString) {
+    MKFNET_SCOPED_TIMER("CalculateCoreLosses");
     try {
         OpenMagnetics::MagneticWrapper magnetic;
         OpenMagnetics::InputsWrapper inputs;
         OpenMagnetics::OperatingPoint operatingPoint;
         if (magneticString.starts_with("{")) {
-            magnetic = OpenMagnetics::MagneticWrapper(json::parse(magneticString));
+            magnetic = OpenMagnetics::MagneticWrapper(parseJson(magneticString));
         }
         else {
-            magnetic = masDatabase[magneticString].get_magnetic();
+            magnetic = getStoredMas(magneticString).get_magnetic();
         }
         if (inputsString.starts_with("{")) {
-            inputs = OpenMagnetics::InputsWrapper(json::parse(inputsString));
+            inputs = OpenMagnetics::InputsWrapper(parseJson(inputsString));
             operatingPoint = inputs.get_operating_point(0);
         }
         else {
             size_t operatingPointIndex = stoi(inputsString);
-            inputs = masDatabase[magneticString].get_inputs();
-            operatingPoint = masDatabase[magneticString].get_inputs().get_operating_points()[operatingPointIndex];
+            inputs = getStoredMas(magneticString).get_inputs();
+            operatingPoint = getStoredMas(magneticString).get_inputs().get_operating_points()[operatingPointIndex];
+        }
+
+        // Catalog materials are resolved once per process instead of on every call
+        auto material = magnetic.get_core().get_functional_description().get_material();
+        if (std::holds_alternative<std::string>(material)) {
+            auto resolvedMaterial = MKFNetInternal::CoreMaterialCache::get_instance().get_material(std::get<std::string>(material));
+            magnetic.get_mutable_core().get_mutable_functional_description().set_material(*resolvedMaterial);
         }
 
         OpenMagnetics::CoreWrapper core = magnetic.get_core();
         OpenMagnetics::CoilWrapper coil = magnetic.get_coil();
         OpenMagnetics::OperatingPointExcitation excitation = operatingPoint.get_excitations_per_winding()[0];
         double magnetizingInductance = OpenMagnetics::resolve_dimensional_values(inputs.get_design_requirements().get_magnetizing_inductance());
-        if (!excitation.get_current()) {
+        bool isPrimaryCurrentSynthesized = !excitation.get_current();
+        if (isPrimaryCurrentSynthesized) {
             auto magnetizingCurrent = OpenMagnetics::InputsWrapper::calculate_magnetizing_current(excitation, magnetizingInductance, true, 0.0);
             excitation.set_current(magnetizingCurrent);
             operatingPoint.get_mutable_excitations_per_winding()[0] = excitation;
         }
+        auto primaryExcitation = operatingPoint.get_excitations_per_winding()[0];
 
         auto defaults = OpenMagnetics::Defaults();
 
-        std::map<std::string, std::string> models = json::parse(modelsString).get<std::map<std::string, std::string>>();
+        json modelsJson = parseJson(modelsString);
+        std::map<std::string, std::string> models;
+        for (auto& [modelKey, modelValue] : modelsJson.items()) {
+            if (modelValue.is_string()) {
+                models[modelKey] = modelValue.get<std::string>();
+            }
+        }
+
+        // By default the core sees the first winding current alone. "magnetizingCurrent": "NET" uses the net ampere-turns of
+        // all windings instead, as described in calculateNetMagnetizingCurrent, with "windingPolarities" giving the sense of
+        // each winding. A magnetizing current synthesized above is never mixed with the load currents of other windings
+        bool useNetMagnetizingCurrent = false;
+        if (models.find("magnetizingCurrent") != models.end()) {
+            std::string magnetizingCurrentStringUpper = models["magnetizingCurrent"];
+            std::transform(magnetizingCurrentStringUpper.begin(), magnetizingCurrentStringUpper.end(), magnetizingCurrentStringUpper.begin(), ::toupper);
+            if (magnetizingCurrentStringUpper != "PRIMARY" && magnetizingCurrentStringUpper != "NET") {
+                throw std::invalid_argument("Unknown magnetizingCurrent " + models["magnetizingCurrent"] + ", expected PRIMARY or NET");
+            }
+            useNetMagnetizingCurrent = magnetizingCurrentStringUpper == "NET";
+        }
+        if (useNetMagnetizingCurrent && !isPrimaryCurrentSynthesized) {
+            std::vector<double> windingPolarities;
+            if (modelsJson.contains("windingPolarities")) {
+                windingPolarities = modelsJson["windingPolarities"].get<std::vector<double>>();
+                if (windingPolarities.size() != operatingPoint.get_excitations_per_winding().size()) {
+                    throw std::invalid_argument("windingPolarities needs one entry per excited winding");
+                }
+                for (auto polarity : windingPolarities) {
+                    if (polarity != 1 && polarity != -1) {
+                        throw std::invalid_argument("windingPolarities entries must be 1 or -1");
+                    }
+                }
+                if (windingPolarities[0] != 1) {
+                    throw std::invalid_argument("windingPolarities are relative to the first winding, whose entry must be 1");
+                }
+            }
+            std::optional<OpenMagnetics::SignalDescriptor> netMagnetizingCurrent;
+            bool keyed = !magneticString.starts_with("{") && !inputsString.starts_with("{");
+            auto cacheKey = std::make_tuple(magneticString, keyed? size_t(stoi(inputsString)) : 0, windingPolarities);
+            if (keyed) {
+                std::shared_lock<std::shared_mutex> lock(databasesMutex);
+                auto magnetizingCurrentIterator = magnetizingCurrentDatabase.find(cacheKey);
+                if (magnetizingCurrentIterator != magnetizingCurrentDatabase.end()) {
+                    netMagnetizingCurrent = magnetizingCurrentIterator->second;
+                }
+            }
+            if (!netMagnetizingCurrent) {
+                netMagnetizingCurrent = calculateNetMagnetizingCurrent(magnetic, operatingPoint, windingPolarities);
+                if (keyed) {
+                    std::unique_lock<std::shared_mutex> lock(databasesMutex);
+                    magnetizingCurrentDatabase[cacheKey] = netMagnetizingCurrent.value();
+                }
+            }
+            excitation.set_current(netMagnetizingCurrent.value());
+            operatingPoint.get_mutable_excitations_per_winding()[0] = excitation;
+        }
 
         auto reluctanceModelName = defaults.reluctanceModelDefault;
         if (models.find("reluctance") != models.end()) {
@@ -940,60 +1491,270 @@ std::string MKFNet::CalculateCoreLosses(std::string magneticString, std::string
         magneticSimulator.set_core_losses_model_name(coreLossesModelName);
         magneticSimulator.set_core_temperature_model_name(coreTemperatureModelName);
         magneticSimulator.set_reluctance_model_name(reluctanceModelName);
+        MKFNET_NAMED_TIMER(coreLossesTimer, "coreLosses");
         auto coreLossesOutput = magneticSimulator.calculate_core_losses(operatingPoint, magnetic);
+        coreLossesTimer.stop();
         json result;
         to_json(result, coreLossesOutput);
 
+        MKFNET_NAMED_TIMER(reluctanceTimer, "reluctance");
         OpenMagnetics::MagnetizingInductance magnetizing_inductance(reluctanceModelName);
         auto magneticFluxDensity = magnetizing_inductance.calculate_inductance_and_magnetic_flux_density(core, coil, &operatingPoint).second;
+        reluctanceTimer.stop();
 
         result["magneticFluxDensityPeak"] = magneticFluxDensity.get_processed().value().get_peak().value();
         result["magneticFluxDensityAcPeak"] = magneticFluxDensity.get_processed().value().get_peak().value() - magneticFluxDensity.get_processed().value().get_offset();
-        result["voltageRms"] = operatingPoint.get_mutable_excitations_per_winding()[0].get_voltage().value().get_processed().value().get_rms().value();
-        result["currentRms"] = operatingPoint.get_mutable_excitations_per_winding()[0].get_current().value().get_processed().value().get_rms().value();
-        result["apparentPower"] = operatingPoint.get_mutable_excitations_per_winding()[0].get_voltage().value().get_processed().value().get_rms().value() * operatingPoint.get_mutable_excitations_per_winding()[0].get_current().value().get_processed().value().get_rms().value();
+        result["voltageRms"] = primaryExcitation.get_voltage().value().get_processed().value().get_rms().value();
+        result["currentRms"] = primaryExcitation.get_current().value().get_processed().value().get_rms().value();
+        result["apparentPower"] = primaryExcitation.get_voltage().value().get_processed().value().get_rms().value() * primaryExcitation.get_current().value().get_processed().value().get_rms().value();
+        result["magnetizingCurrentRms"] = operatingPoint.get_mutable_excitations_per_winding()[0].get_current().value().get_processed().value().get_rms().value();
         if (coreLossesOutput.get_temperature()) {
             result["maximumCoreTemperature"] = coreLossesOutput.get_temperature().value();
             result["maximumCoreTemperatureRise"] = coreLossesOutput.get_temperature().value() - operatingPoint.get_conditions().get_ambient_temperature();
         }
 
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
     }
 }
 
-std::string MKFNet::CalculateAdvisedCores(std::string inputsString, std::string weightsString, int maximumNumberResults, bool useOnlyCoresInStock){
+double MKFNet::CalculateCoreLossesDensity(std::string materialName, std::string modelName, double magneticFluxDensityPeak, double frequency, double temperature) {
+    MKFNET_SCOPED_TIMER("CalculateCoreLossesDensity");
     try {
-        OpenMagnetics::InputsWrapper inputs(json::parse(inputsString));
-        std::map<std::string, double> weightsKeysString = json::parse(weightsString);
-        std::map<OpenMagnetics::CoreAdviser::CoreAdviserFilters, double> weights;
-
-        for (auto const& pair : weightsKeysString) {
-            weights[magic_enum::enum_cast<OpenMagnetics::CoreAdviser::CoreAdviserFilters>(pair.first).value()] = pair.second;
+        auto coreLossesModelName = OpenMagnetics::Defaults().coreLossesModelDefault;
+        if (modelName != "") {
+            std::transform(modelName.begin(), modelName.end(), modelName.begin(), ::toupper);
+            coreLossesModelName = magic_enum::enum_cast<OpenMagnetics::CoreLossesModels>(modelName).value();
         }
-        weights[OpenMagnetics::CoreAdviser::CoreAdviserFilters::AREA_PRODUCT] = 1;
-        weights[OpenMagnetics::CoreAdviser::CoreAdviserFilters::ENERGY_STORED] = 1;
-        weights[OpenMagnetics::CoreAdviser::CoreAdviserFilters::COST] = 1;
-        weights[OpenMagnetics::CoreAdviser::CoreAdviserFilters::EFFICIENCY] = 1;
-        weights[OpenMagnetics::CoreAdviser::CoreAdviserFilters::DIMENSIONS] = 1;
-
-        auto settings = OpenMagnetics::Settings::GetInstance();
-        settings->set_use_only_cores_in_stock(useOnlyCoresInStock);
-
-        OpenMagnetics::CoreAdviser coreAdviser;
-        auto masMagnetics = coreAdviser.get_advised_core(inputs, weights, maximumNumberResults);
 
-        json results = json::array();
-        for (auto& masMagnetic : masMagnetics) {
-            json aux;
-            to_json(aux, masMagnetic.first);
-            results.push_back(aux);
+        auto& coreMaterialCache = MKFNetInternal::CoreMaterialCache::get_instance();
+        // A surface that could not be built still leaves the direct model to try
+        std::optional<double> volumetricLosses;
+        try {
+            volumetricLosses = coreMaterialCache.get_core_losses_density_surface(materialName, coreLossesModelName)->get_volumetric_losses(magneticFluxDensityPeak, frequency, temperature);
+        }
+        catch (...) {
+        }
+        if (volumetricLosses) {
+            return volumetricLosses.value();
         }
-        settings->reset();
 
-        return results.dump(4);
+        auto excitation = MKFNetInternal::create_magnetic_flux_density_excitation(OpenMagnetics::WaveformLabel::SINUSOIDAL, magneticFluxDensityPeak, frequency);
+        auto coreLossesModel = OpenMagnetics::CoreLossesModel::factory(coreLossesModelName);
+        return coreLossesModel->get_core_volumetric_losses(*coreMaterialCache.get_material(materialName), excitation, temperature);
+    }
+    catch (const std::exception &exc) {
+        return -1;
+    }
+}
+
+std::string MKFNet::CalculateCoreLossesDensityMap(std::string materialNamesString, std::string magneticFluxDensityPeaksString, std::string frequenciesString, std::string temperaturesString, std::string waveformShapesString, std::string modelName, int numberThreads) {
+    MKFNET_SCOPED_TIMER("CalculateCoreLossesDensityMap");
+    try {
+        auto materialNames = parseJson(materialNamesString).get<std::vector<std::string>>();
+        auto magneticFluxDensityPeaks = parseJson(magneticFluxDensityPeaksString).get<std::vector<double>>();
+        auto frequencies = parseJson(frequenciesString).get<std::vector<double>>();
+        auto temperatures = parseJson(temperaturesString).get<std::vector<double>>();
+        std::vector<OpenMagnetics::WaveformLabel> waveformShapes;
+        if (waveformShapesString == "" || waveformShapesString == "[]") {
+            waveformShapes.push_back(OpenMagnetics::WaveformLabel::SINUSOIDAL);
+        }
+        else {
+            for (auto& waveformShapeJson : parseJson(waveformShapesString)) {
+                OpenMagnetics::WaveformLabel waveformShape;
+                from_json(waveformShapeJson, waveformShape);
+                waveformShapes.push_back(waveformShape);
+            }
+        }
+        auto coreLossesModelName = OpenMagnetics::Defaults().coreLossesModelDefault;
+        if (modelName != "") {
+            std::transform(modelName.begin(), modelName.end(), modelName.begin(), ::toupper);
+            coreLossesModelName = magic_enum::enum_cast<OpenMagnetics::CoreLossesModels>(modelName).value();
+        }
+
+        // Packed as [material][waveform shape][peak B][frequency][temperature], row major
+        size_t numberPointsPerCurve = frequencies.size() * temperatures.size();
+        std::vector<double> volumetricLosses(materialNames.size() * waveformShapes.size() * magneticFluxDensityPeaks.size() * numberPointsPerCurve, -1);
+
+        auto& coreMaterialCache = MKFNetInternal::CoreMaterialCache::get_instance();
+        // Each evaluation returns the first error it met, empty when all its points were computed
+        std::vector<std::pair<size_t, std::future<std::string>>> evaluations;
+        MKFNetInternal::ThreadPool pool(std::max(0, numberThreads));
+        for (size_t materialIndex = 0; materialIndex < materialNames.size(); materialIndex++) {
+            for (size_t waveformShapeIndex = 0; waveformShapeIndex < waveformShapes.size(); waveformShapeIndex++) {
+                for (size_t magneticFluxDensityIndex = 0; magneticFluxDensityIndex < magneticFluxDensityPeaks.size(); magneticFluxDensityIndex++) {
+                    size_t firstIndex = ((materialIndex * waveformShapes.size() + waveformShapeIndex) * magneticFluxDensityPeaks.size() + magneticFluxDensityIndex) * numberPointsPerCurve;
+                    evaluations.emplace_back(materialIndex, pool.submit([&, materialIndex, waveformShapeIndex, magneticFluxDensityIndex, firstIndex]() {
+                        // Models are not shared between threads, as some keep state between evaluations
+                        std::shared_ptr<const OpenMagnetics::CoreMaterial> material;
+                        std::shared_ptr<OpenMagnetics::CoreLossesModel> coreLossesModel;
+                        try {
+                            material = coreMaterialCache.get_material(materialNames[materialIndex]);
+                            coreLossesModel = OpenMagnetics::CoreLossesModel::factory(coreLossesModelName);
+                        }
+                        catch (const std::exception &exc) {
+                            return std::string{exc.what()};
+                        }
+                        std::string error;
+                        for (size_t frequencyIndex = 0; frequencyIndex < frequencies.size(); frequencyIndex++) {
+                            try {
+                                auto excitation = MKFNetInternal::create_magnetic_flux_density_excitation(waveformShapes[waveformShapeIndex], magneticFluxDensityPeaks[magneticFluxDensityIndex], frequencies[frequencyIndex]);
+                                for (size_t temperatureIndex = 0; temperatureIndex < temperatures.size(); temperatureIndex++) {
+                                    volumetricLosses[firstIndex + frequencyIndex * temperatures.size() + temperatureIndex] = coreLossesModel->get_core_volumetric_losses(*material, excitation, temperatures[temperatureIndex]);
+                                }
+                            }
+                            catch (const std::exception &exc) {
+                                if (error.empty()) {
+                                    error = exc.what();
+                                }
+                            }
+                        }
+                        return error;
+                    }));
+                }
+            }
+        }
+        std::vector<std::string> errorPerMaterial(materialNames.size());
+        for (auto& [materialIndex, evaluation] : evaluations) {
+            auto error = evaluation.get();
+            if (errorPerMaterial[materialIndex].empty()) {
+                errorPerMaterial[materialIndex] = error;
+            }
+        }
+
+        json result;
+        result["materials"] = materialNames;
+        result["waveformShapes"] = json::array();
+        for (auto waveformShape : waveformShapes) {
+            json waveformShapeJson;
+            to_json(waveformShapeJson, waveformShape);
+            result["waveformShapes"].push_back(waveformShapeJson);
+        }
+        result["magneticFluxDensityPeaks"] = magneticFluxDensityPeaks;
+        result["frequencies"] = frequencies;
+        result["temperatures"] = temperatures;
+        result["shape"] = {materialNames.size(), waveformShapes.size(), magneticFluxDensityPeaks.size(), frequencies.size(), temperatures.size()};
+        result["volumetricLosses"] = volumetricLosses;
+        // Points left at -1 belong to a material listed here with the first error it raised
+        result["errors"] = json::array();
+        for (size_t materialIndex = 0; materialIndex < materialNames.size(); materialIndex++) {
+            if (!errorPerMaterial[materialIndex].empty()) {
+                result["errors"].push_back({{"material", materialNames[materialIndex]}, {"error", errorPerMaterial[materialIndex]}});
+            }
+        }
+        return dumpJson(result);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+double MKFNet::CalculateInitialPermeability(std::string materialName, double magneticFieldDcBias, double temperature) {
+    MKFNET_SCOPED_TIMER("CalculateInitialPermeability");
+    try {
+        return MKFNetInternal::CoreMaterialCache::get_instance().get_initial_permeability_surface(materialName)->get_initial_permeability(magneticFieldDcBias, temperature);
+    }
+    catch (const std::exception &exc) {
+        return -1;
+    }
+}
+
+std::string MKFNet::PrecomputeCoreMaterials(std::string materialNamesString, std::string modelNamesString, int numberThreads) {
+    MKFNET_SCOPED_TIMER("PrecomputeCoreMaterials");
+    try {
+        std::vector<std::string> materialNames;
+        if (materialNamesString == "" || materialNamesString == "[]") {
+            materialNames = OpenMagnetics::get_material_names(std::nullopt);
+        }
+        else {
+            materialNames = parseJson(materialNamesString).get<std::vector<std::string>>();
+        }
+        std::vector<OpenMagnetics::CoreLossesModels> coreLossesModelNames;
+        if (modelNamesString == "" || modelNamesString == "[]") {
+            coreLossesModelNames.push_back(OpenMagnetics::Defaults().coreLossesModelDefault);
+        }
+        else {
+            for (std::string modelName : parseJson(modelNamesString).get<std::vector<std::string>>()) {
+                std::transform(modelName.begin(), modelName.end(), modelName.begin(), ::toupper);
+                coreLossesModelNames.push_back(magic_enum::enum_cast<OpenMagnetics::CoreLossesModels>(modelName).value());
+            }
+        }
+
+        auto& coreMaterialCache = MKFNetInternal::CoreMaterialCache::get_instance();
+        std::vector<std::future<bool>> precomputations;
+        MKFNetInternal::ThreadPool pool(std::max(0, numberThreads));
+        for (auto& materialName : materialNames) {
+            precomputations.push_back(pool.submit([&coreMaterialCache, &materialName, &coreLossesModelNames]() {
+                // Materials without data for a model are left for the direct calculation to report
+                bool precomputed = true;
+                for (auto coreLossesModelName : coreLossesModelNames) {
+                    try {
+                        precomputed &= !coreMaterialCache.get_core_losses_density_surface(materialName, coreLossesModelName)->is_empty();
+                    }
+                    catch (...) {
+                        precomputed = false;
+                    }
+                }
+                try {
+                    coreMaterialCache.get_initial_permeability_surface(materialName);
+                }
+                catch (...) {
+                    precomputed = false;
+                }
+                return precomputed;
+            }));
+        }
+
+        size_t numberPrecomputedMaterials = 0;
+        for (auto& precomputation : precomputations) {
+            numberPrecomputedMaterials += precomputation.get();
+        }
+        return std::to_string(numberPrecomputedMaterials);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+void MKFNet::ClearCoreMaterialCache() {
+    MKFNET_SCOPED_TIMER("ClearCoreMaterialCache");
+    MKFNetInternal::CoreMaterialCache::get_instance().clear();
+}
+
+std::string MKFNet::CalculateAdvisedCores(std::string inputsString, std::string weightsString, int maximumNumberResults, bool useOnlyCoresInStock){
+    MKFNET_SCOPED_TIMER("CalculateAdvisedCores");
+    try {
+        OpenMagnetics::InputsWrapper inputs(parseJson(inputsString));
+        std::map<std::string, double> weightsKeysString = parseJson(weightsString);
+        std::map<OpenMagnetics::CoreAdviser::CoreAdviserFilters, double> weights;
+
+        for (auto const& pair : weightsKeysString) {
+            weights[magic_enum::enum_cast<OpenMagnetics::CoreAdviser::CoreAdviserFilters>(pair.first).value()] = pair.second;
+        }
+        weights[OpenMagnetics::CoreAdviser::CoreAdviserFilters::AREA_PRODUCT] = 1;
+        weights[OpenMagnetics::CoreAdviser::CoreAdviserFilters::ENERGY_STORED] = 1;
+        weights[OpenMagnetics::CoreAdviser::CoreAdviserFilters::COST] = 1;
+        weights[OpenMagnetics::CoreAdviser::CoreAdviserFilters::EFFICIENCY] = 1;
+        weights[OpenMagnetics::CoreAdviser::CoreAdviserFilters::DIMENSIONS] = 1;
+
+        std::unique_lock<std::shared_mutex> settingsLock(settingsMutex);
+        auto settings = OpenMagnetics::Settings::GetInstance();
+        settings->set_use_only_cores_in_stock(useOnlyCoresInStock);
+
+        OpenMagnetics::CoreAdviser coreAdviser;
+        auto masMagnetics = coreAdviser.get_advised_core(inputs, weights, maximumNumberResults);
+
+        json results = json::array();
+        for (auto& masMagnetic : masMagnetics) {
+            json aux;
+            to_json(aux, masMagnetic.first);
+            results.push_back(aux);
+        }
+        settings->reset();
+
+        return dumpJson(results);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1001,8 +1762,9 @@ std::string MKFNet::CalculateAdvisedCores(std::string inputsString, std::string
 }
 
 std::string MKFNet::CalculateAdvisedMagnetics(std::string inputsString, int maximumNumberResults){
+    MKFNET_SCOPED_TIMER("CalculateAdvisedMagnetics");
     try {
-        OpenMagnetics::InputsWrapper inputs(json::parse(inputsString));
+        OpenMagnetics::InputsWrapper inputs(parseJson(inputsString));
 
         OpenMagnetics::MagneticAdviser magneticAdviser;
         auto masMagnetics = magneticAdviser.get_advised_magnetic(inputs, maximumNumberResults);
@@ -1014,7 +1776,7 @@ std::string MKFNet::CalculateAdvisedMagnetics(std::string inputsString, int maxi
             results.push_back(aux);
         }
 
-        return results.dump(4);
+        return dumpJson(results);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1022,31 +1784,197 @@ std::string MKFNet::CalculateAdvisedMagnetics(std::string inputsString, int maxi
 }
 
 std::string MKFNet::CalculateWindingLosses(std::string magneticString, std::string operatingPointString, double temperature, double windingLossesHarmonicAmplitudeThreshold) {
+    MKFNET_SCOPED_TIMER("CalculateWindingLosses");
     try {
         auto settings = OpenMagnetics::Settings::GetInstance();
         OpenMagnetics::MagneticWrapper magnetic;
         OpenMagnetics::OperatingPoint operatingPoint;
         if (magneticString.starts_with("{")) {
-            magnetic = OpenMagnetics::MagneticWrapper(json::parse(magneticString));
+            magnetic = OpenMagnetics::MagneticWrapper(parseJson(magneticString));
         }
         else {
-            magnetic = masDatabase[magneticString].get_magnetic();
+            magnetic = getStoredMas(magneticString).get_magnetic();
         }
         if (operatingPointString.starts_with("{")) {
-            operatingPoint = OpenMagnetics::OperatingPoint(json::parse(operatingPointString));
+            operatingPoint = OpenMagnetics::OperatingPoint(parseJson(operatingPointString));
         }
         else {
             size_t operatingPointIndex = stoi(operatingPointString);
-            operatingPoint = masDatabase[magneticString].get_inputs().get_operating_points()[operatingPointIndex];
+            operatingPoint = getStoredMas(magneticString).get_inputs().get_operating_points()[operatingPointIndex];
         }
 
+        // The model reads the threshold from the global settings only, so it is set and restored while no job reads them
         auto windingLossesModel = OpenMagnetics::WindingLosses(); 
+        std::unique_lock<std::shared_mutex> settingsLock(settingsMutex);
+        auto previousHarmonicAmplitudeThreshold = settings->get_harmonic_amplitude_threshold();
         settings->set_harmonic_amplitude_threshold(windingLossesHarmonicAmplitudeThreshold);
-        auto windingLossesOutput = windingLossesModel.calculate_losses(magnetic, operatingPoint, temperature);
+        OpenMagnetics::WindingLossesOutput windingLossesOutput;
+        try {
+            MKFNET_NAMED_TIMER(windingLossesTimer, "windingLosses");
+            windingLossesOutput = windingLossesModel.calculate_losses(magnetic, operatingPoint, temperature);
+        }
+        catch (...) {
+            settings->set_harmonic_amplitude_threshold(previousHarmonicAmplitudeThreshold);
+            throw;
+        }
+        settings->set_harmonic_amplitude_threshold(previousHarmonicAmplitudeThreshold);
+        settingsLock.unlock();
 
         json result;
         to_json(result, windingLossesOutput);
-        return result.dump(4);
+        return dumpJson(result);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+// Exhaustive pattern searches beyond this many candidates are refused instead of running for hours
+constexpr size_t maximumWindingPatternCandidates = 100000;
+
+// Choices of one candidate; the coil is copied and wound only by the worker evaluating it
+struct WindingPatternCandidate {
+    std::vector<size_t> pattern;
+    size_t repetitions;
+    OpenMagnetics::WindingOrientation windingOrientation;
+    OpenMagnetics::WindingOrientation layersOrientation;
+    OpenMagnetics::CoilAlignment sectionAlignment;
+    OpenMagnetics::CoilWrapper coil;
+    double fillingFactor = 0;
+    double windingLosses = 0;
+};
+
+std::optional<WindingPatternCandidate> evaluateWindingPattern(WindingPatternCandidate candidate, OpenMagnetics::MagneticWrapper magnetic, OpenMagnetics::OperatingPoint operatingPoint, double temperature) {
+    candidate.coil = magnetic.get_coil();
+    auto& coil = candidate.coil;
+    coil.set_sections_description(std::nullopt);
+    coil.set_layers_description(std::nullopt);
+    coil.set_turns_description(std::nullopt);
+    coil.set_winding_orientation(candidate.windingOrientation);
+    coil.set_layers_orientation(candidate.layersOrientation);
+    coil.set_section_alignment(candidate.sectionAlignment);
+    coil.wind(candidate.pattern, candidate.repetitions);
+    if (!coil.get_turns_description()) {
+        return std::nullopt;
+    }
+
+    auto sections = coil.get_sections_description().value();
+    for (auto& section : sections) {
+        if (section.get_filling_factor()) {
+            candidate.fillingFactor = std::max(candidate.fillingFactor, section.get_filling_factor().value());
+        }
+    }
+    // Sections filled beyond their space describe a coil that does not fit the winding window
+    if (candidate.fillingFactor > 1) {
+        return std::nullopt;
+    }
+
+    magnetic.set_coil(coil);
+    auto windingLossesOutput = OpenMagnetics::WindingLosses().calculate_losses(magnetic, operatingPoint, temperature);
+    candidate.windingLosses = windingLossesOutput.get_winding_losses();
+    return candidate;
+}
+
+std::string MKFNet::CalculateWindingPatterns(std::string magneticString, std::string operatingPointString, double temperature, int maximumRepetitions, int numberThreads) {
+    MKFNET_SCOPED_TIMER("CalculateWindingPatterns");
+    try {
+        OpenMagnetics::MagneticWrapper magnetic;
+        OpenMagnetics::OperatingPoint operatingPoint;
+        if (magneticString.starts_with("{")) {
+            magnetic = OpenMagnetics::MagneticWrapper(parseJson(magneticString));
+        }
+        else {
+            magnetic = getStoredMas(magneticString).get_magnetic();
+        }
+        if (operatingPointString.starts_with("{")) {
+            operatingPoint = OpenMagnetics::OperatingPoint(parseJson(operatingPointString));
+        }
+        else {
+            size_t operatingPointIndex = stoi(operatingPointString);
+            operatingPoint = getStoredMas(magneticString).get_inputs().get_operating_points()[operatingPointIndex];
+        }
+
+        size_t numberWindings = magnetic.get_coil().get_functional_description().size();
+        size_t numberRepetitions = size_t(std::max(1, maximumRepetitions));
+        size_t numberCandidates = numberRepetitions * magic_enum::enum_count<OpenMagnetics::WindingOrientation>() * magic_enum::enum_count<OpenMagnetics::WindingOrientation>() * magic_enum::enum_count<OpenMagnetics::CoilAlignment>();
+        for (size_t windingIndex = 2; windingIndex <= numberWindings && numberCandidates <= maximumWindingPatternCandidates; windingIndex++) {
+            numberCandidates *= windingIndex;
+        }
+        if (numberCandidates > maximumWindingPatternCandidates) {
+            throw std::invalid_argument("Winding pattern search over " + std::to_string(numberWindings) + " windings and " + std::to_string(numberRepetitions) + " repetitions exceeds " + std::to_string(maximumWindingPatternCandidates) + " candidates");
+        }
+
+        // Pareto front minimizing both the worst section filling factor and the AC winding losses, kept as
+        // candidates finish so that only the front, and not every wound coil, stays in memory
+        std::vector<WindingPatternCandidate> front;
+        auto addToFront = [&front](WindingPatternCandidate candidate) {
+            for (auto& member : front) {
+                if (member.fillingFactor <= candidate.fillingFactor && member.windingLosses <= candidate.windingLosses) {
+                    return;
+                }
+            }
+            std::erase_if(front, [&candidate](const WindingPatternCandidate& member) {
+                return candidate.fillingFactor <= member.fillingFactor && candidate.windingLosses <= member.windingLosses;
+            });
+            front.push_back(std::move(candidate));
+        };
+
+        MKFNetInternal::ThreadPool pool(std::max(0, numberThreads));
+        size_t maximumEvaluationsInFlight = 4 * pool.get_number_threads();
+        std::deque<std::future<std::optional<WindingPatternCandidate>>> evaluations;
+        auto collectEvaluation = [&evaluations, &addToFront]() {
+            auto woundCandidate = evaluations.front().get();
+            evaluations.pop_front();
+            if (woundCandidate) {
+                addToFront(std::move(woundCandidate.value()));
+            }
+        };
+
+        std::vector<size_t> pattern(numberWindings);
+        std::iota(pattern.begin(), pattern.end(), 0);
+        do {
+            for (size_t repetitions = 1; repetitions <= numberRepetitions; repetitions++) {
+                for (auto windingOrientation : magic_enum::enum_values<OpenMagnetics::WindingOrientation>()) {
+                    for (auto layersOrientation : magic_enum::enum_values<OpenMagnetics::WindingOrientation>()) {
+                        for (auto sectionAlignment : magic_enum::enum_values<OpenMagnetics::CoilAlignment>()) {
+                            WindingPatternCandidate candidate{pattern, repetitions, windingOrientation, layersOrientation, sectionAlignment};
+                            evaluations.push_back(pool.submit([candidate = std::move(candidate), &magnetic, &operatingPoint, temperature]() -> std::optional<WindingPatternCandidate> {
+                                try {
+                                    return evaluateWindingPattern(candidate, magnetic, operatingPoint, temperature);
+                                }
+                                catch (...) {
+                                    return std::nullopt;
+                                }
+                            }));
+                            if (evaluations.size() >= maximumEvaluationsInFlight) {
+                                collectEvaluation();
+                            }
+                        }
+                    }
+                }
+            }
+        } while (std::next_permutation(pattern.begin(), pattern.end()));
+        while (!evaluations.empty()) {
+            collectEvaluation();
+        }
+
+        std::sort(front.begin(), front.end(), [](const WindingPatternCandidate& a, const WindingPatternCandidate& b) {
+            return a.fillingFactor < b.fillingFactor;
+        });
+        json results = json::array();
+        for (auto& woundCandidate : front) {
+            json result;
+            result["pattern"] = woundCandidate.pattern;
+            result["repetitions"] = woundCandidate.repetitions;
+            result["windingOrientation"] = woundCandidate.windingOrientation;
+            result["layersOrientation"] = woundCandidate.layersOrientation;
+            result["sectionAlignment"] = woundCandidate.sectionAlignment;
+            result["fillingFactor"] = woundCandidate.fillingFactor;
+            result["windingLosses"] = woundCandidate.windingLosses;
+            to_json(result["coil"], woundCandidate.coil);
+            results.push_back(result);
+        }
+        return dumpJson(results);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1054,22 +1982,23 @@ std::string MKFNet::CalculateWindingLosses(std::string magneticString, std::stri
 }
 
 std::string MKFNet::CalculateEffectiveCurrentDensity(std::string magneticString, std::string operatingPointString, double temperature) {
+    MKFNET_SCOPED_TIMER("CalculateEffectiveCurrentDensity");
     try {
 
         OpenMagnetics::MagneticWrapper magnetic;
         OpenMagnetics::OperatingPoint operatingPoint;
         if (magneticString.starts_with("{")) {
-            magnetic = OpenMagnetics::MagneticWrapper(json::parse(magneticString));
+            magnetic = OpenMagnetics::MagneticWrapper(parseJson(magneticString));
         }
         else {
-            magnetic = masDatabase[magneticString].get_magnetic();
+            magnetic = getStoredMas(magneticString).get_magnetic();
         }
         if (operatingPointString.starts_with("{")) {
-            operatingPoint = OpenMagnetics::OperatingPoint(json::parse(operatingPointString));
+            operatingPoint = OpenMagnetics::OperatingPoint(parseJson(operatingPointString));
         }
         else {
             size_t operatingPointIndex = stoi(operatingPointString);
-            operatingPoint = masDatabase[magneticString].get_inputs().get_operating_points()[operatingPointIndex];
+            operatingPoint = getStoredMas(magneticString).get_inputs().get_operating_points()[operatingPointIndex];
         }
 
         auto wires = magnetic.get_mutable_coil().get_wires();
@@ -1083,7 +2012,7 @@ std::string MKFNet::CalculateEffectiveCurrentDensity(std::string magneticString,
             double effectiveCurrentDensity = wire.calculate_effective_current_density(rms, frequency, temperature);
             result.push_back(std::to_string(effectiveCurrentDensity));
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1091,32 +2020,300 @@ std::string MKFNet::CalculateEffectiveCurrentDensity(std::string magneticString,
 }
 
 std::string MKFNet::CalculateOhmicLosses(std::string coilString, std::string operatingPointString, double temperature) {
+    MKFNET_SCOPED_TIMER("CalculateOhmicLosses");
     try {
-        OpenMagnetics::CoilWrapper coil(json::parse(coilString));
-        OpenMagnetics::OperatingPoint operatingPoint(json::parse(operatingPointString));
+        OpenMagnetics::CoilWrapper coil(parseJson(coilString));
+        OpenMagnetics::OperatingPoint operatingPoint(parseJson(operatingPointString));
 
         auto windingLossesOutput = OpenMagnetics::WindingOhmicLosses::calculate_ohmic_losses(coil, operatingPoint, temperature);
 
         json result;
         to_json(result, windingLossesOutput);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
     }
 }
 
-std::string MKFNet::CalculateMagneticFieldStrengthField(std::string operatingPointString, std::string magneticString) {
+std::shared_ptr<const MKFNetInternal::TurnTable> getTurnTable(std::string magneticString, OpenMagnetics::MagneticWrapper& magnetic) {
+    if (magneticString.starts_with("{")) {
+        return std::make_shared<const MKFNetInternal::TurnTable>(MKFNetInternal::build_turn_table(magnetic.get_mutable_coil()));
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(databasesMutex);
+        auto turnTableIterator = turnTableDatabase.find(magneticString);
+        if (turnTableIterator != turnTableDatabase.end()) {
+            return turnTableIterator->second;
+        }
+    }
+    auto turnTable = std::make_shared<const MKFNetInternal::TurnTable>(MKFNetInternal::build_turn_table(magnetic.get_mutable_coil()));
+    std::unique_lock<std::shared_mutex> lock(databasesMutex);
+    return turnTableDatabase.emplace(magneticString, turnTable).first->second;
+}
+
+// Phase of each harmonic of a current, from its waveform sampled over one period. Harmonics given without a
+// waveform carry no phase, so they are taken as cosines in phase with each other
+std::vector<double> calculateHarmonicPhases(const OpenMagnetics::SignalDescriptor& current, const OpenMagnetics::Harmonics& harmonics, double frequency) {
+    std::vector<double> phases(harmonics.get_frequencies().size(), 0);
+    if (!current.get_waveform()) {
+        return phases;
+    }
+    auto sampledWaveform = OpenMagnetics::InputsWrapper::calculate_sampled_waveform(current.get_waveform().value(), frequency);
+    auto& data = sampledWaveform.get_data();
+    for (size_t harmonicIndex = 0; harmonicIndex < phases.size(); harmonicIndex++) {
+        double harmonicOrder = std::round(harmonics.get_frequencies()[harmonicIndex] / frequency);
+        double cosineSum = 0;
+        double sineSum = 0;
+        for (size_t sampleIndex = 0; sampleIndex < data.size(); sampleIndex++) {
+            double angle = 2 * std::numbers::pi * harmonicOrder * sampleIndex / data.size();
+            cosineSum += data[sampleIndex] * std::cos(angle);
+            sineSum -= data[sampleIndex] * std::sin(angle);
+        }
+        phases[harmonicIndex] = std::atan2(sineSum, cosineSum);
+    }
+    return phases;
+}
+
+// How the winding currents of each harmonic are combined: by the phase of each current, or as MKF's MagneticField
+// combines them, each amplitude signed by a fixed direction, the first winding positive and every other against it
+enum class WindingCurrentSigns {
+    PHASES,
+    MAGNETIC_FIELD_DIRECTIONS
+};
+
+// Field of the turns alone, mirrored mirroringDimension times on the winding window walls, by default as many as
+// MKF's magnetic field uses. The fringing of the core gaps is not modelled, so the field next to a gap is
+// underestimated. At most numberThreads threads are used, 0 meaning every core
+OpenMagnetics::WindingWindowMagneticStrengthFieldOutput calculateWindingWindowMagneticStrengthField(const MKFNetInternal::TurnTable& turnTable, OpenMagnetics::MagneticWrapper& magnetic, OpenMagnetics::OperatingPoint operatingPoint, size_t numberPointsX = 0, size_t numberPointsY = 0, size_t numberThreads = 1, std::optional<size_t> mirroringDimension = std::nullopt, WindingCurrentSigns windingCurrentSigns = WindingCurrentSigns::PHASES) {
+    auto settings = OpenMagnetics::Settings::GetInstance();
+    if (!mirroringDimension) {
+        mirroringDimension = settings->get_magnetic_field_mirroring_dimension();
+    }
+    auto bobbin = magnetic.get_mutable_coil().resolve_bobbin();
+    auto windingWindow = bobbin.get_processed_description()->get_winding_windows()[0];
+    auto windingWindowCoordinates = windingWindow.get_coordinates().value();
+    double windingWindowWidth = windingWindow.get_width().value();
+    double windingWindowHeight = windingWindow.get_height().value();
+
+    size_t numberWindings = turnTable.numberParallelsPerWinding.size();
+    std::vector<OpenMagnetics::Harmonics> harmonicsPerWinding;
+    std::vector<std::vector<double>> phasesPerWinding;
+    double maximumHarmonicAmplitude = 0;
+    for (size_t windingIndex = 0; windingIndex < numberWindings; windingIndex++) {
+        auto excitation = operatingPoint.get_excitations_per_winding()[windingIndex];
+        auto current = excitation.get_current().value();
+        if (!current.get_harmonics()) {
+            auto sampledWaveform = OpenMagnetics::InputsWrapper::calculate_sampled_waveform(current.get_waveform().value(), excitation.get_frequency());
+            current.set_harmonics(OpenMagnetics::InputsWrapper::calculate_harmonics_data(sampledWaveform, excitation.get_frequency()));
+        }
+        auto harmonics = current.get_harmonics().value();
+        for (auto amplitude : harmonics.get_amplitudes()) {
+            maximumHarmonicAmplitude = std::max(maximumHarmonicAmplitude, amplitude);
+        }
+        phasesPerWinding.push_back(calculateHarmonicPhases(current, harmonics, excitation.get_frequency()));
+        harmonicsPerWinding.push_back(harmonics);
+    }
+    double harmonicAmplitudeThreshold = settings->get_harmonic_amplitude_threshold() * maximumHarmonicAmplitude;
+
+    // Equivalent round conductor for each turn, so the field inside it stays finite
+    std::vector<double> turnRadius(turnTable.size());
+    for (size_t turnIndex = 0; turnIndex < turnTable.size(); turnIndex++) {
+        if (turnTable.width[turnIndex] == turnTable.height[turnIndex]) {
+            turnRadius[turnIndex] = turnTable.width[turnIndex] / 2;
+        }
+        else {
+            turnRadius[turnIndex] = std::sqrt(turnTable.width[turnIndex] * turnTable.height[turnIndex] / std::numbers::pi);
+        }
+    }
+
+    // Field is evaluated at the turn centres, as proximity losses need, unless a grid over the winding window is requested
+    bool useGrid = numberPointsX > 0 && numberPointsY > 0;
+    std::vector<double> pointsX = turnTable.x;
+    std::vector<double> pointsY = turnTable.y;
+    if (useGrid) {
+        pointsX.clear();
+        pointsY.clear();
+        for (size_t pointIndexY = 0; pointIndexY < numberPointsY; pointIndexY++) {
+            for (size_t pointIndexX = 0; pointIndexX < numberPointsX; pointIndexX++) {
+                pointsX.push_back(windingWindowCoordinates[0] - windingWindowWidth / 2 + windingWindowWidth * (pointIndexX + 0.5) / numberPointsX);
+                pointsY.push_back(windingWindowCoordinates[1] - windingWindowHeight / 2 + windingWindowHeight * (pointIndexY + 0.5) / numberPointsY);
+            }
+        }
+    }
+
+    std::vector<OpenMagnetics::ComplexField> fieldPerFrequency;
+    std::vector<double> fieldX(pointsX.size());
+    std::vector<double> fieldY(pointsX.size());
+    std::vector<double> quadratureFieldX(pointsX.size());
+    std::vector<double> quadratureFieldY(pointsX.size());
+    // One pool serves every harmonic, and only when the sum is large enough to be worth splitting
+    size_t numberImages = (2 * mirroringDimension.value() + 1) * (2 * mirroringDimension.value() + 1);
+    numberThreads = MKFNetInternal::get_field_kernel_number_threads(pointsX.size() * turnTable.size() * numberImages, numberThreads);
+    std::optional<MKFNetInternal::ThreadPool> pool;
+    if (numberThreads > 1) {
+        pool.emplace(numberThreads);
+    }
+    auto instructionSet = MKFNetInternal::get_field_kernel_instruction_set();
+    auto& frequencies = harmonicsPerWinding[0].get_frequencies();
+    for (size_t harmonicIndex = 0; harmonicIndex < frequencies.size(); harmonicIndex++) {
+        bool isHarmonicRelevant = false;
+        for (auto& harmonics : harmonicsPerWinding) {
+            if (harmonicIndex < harmonics.get_amplitudes().size() && harmonics.get_amplitudes()[harmonicIndex] >= harmonicAmplitudeThreshold) {
+                isHarmonicRelevant = true;
+            }
+        }
+        if (!isHarmonicRelevant) {
+            continue;
+        }
+
+        // Every winding is wound the same way and MAS currents flow into the dotted end, so a current keeps its
+        // sign. Each harmonic is split into the part in phase with the first winding and the part in quadrature
+        MKFNetInternal::FieldSources sources;
+        MKFNetInternal::FieldSources quadratureSources;
+        bool hasQuadratureCurrent = false;
+        double referencePhase = harmonicIndex < phasesPerWinding[0].size()? phasesPerWinding[0][harmonicIndex] : 0;
+        for (size_t turnIndex = 0; turnIndex < turnTable.size(); turnIndex++) {
+            auto windingIndex = turnTable.windingIndex[turnIndex];
+            auto& amplitudes = harmonicsPerWinding[windingIndex].get_amplitudes();
+            double current = harmonicIndex < amplitudes.size()? amplitudes[harmonicIndex] : 0;
+            current /= turnTable.numberParallelsPerWinding[windingIndex];
+            double phase = harmonicIndex < phasesPerWinding[windingIndex].size()? phasesPerWinding[windingIndex][harmonicIndex] - referencePhase : 0;
+            if (windingCurrentSigns == WindingCurrentSigns::MAGNETIC_FIELD_DIRECTIONS) {
+                phase = windingIndex == 0? 0 : std::numbers::pi;
+            }
+            double quadratureCurrent = current * std::sin(phase);
+            if (std::abs(quadratureCurrent) > 1e-9 * std::abs(current)) {
+                hasQuadratureCurrent = true;
+            }
+            sources.push_back(turnTable.x[turnIndex], turnTable.y[turnIndex], turnRadius[turnIndex], current * std::cos(phase));
+            quadratureSources.push_back(turnTable.x[turnIndex], turnTable.y[turnIndex], turnRadius[turnIndex], quadratureCurrent);
+        }
+        auto mirrorSources = [&](const MKFNetInternal::FieldSources& unmirroredSources) {
+            return MKFNetInternal::add_mirrored_sources(unmirroredSources,
+                                                        windingWindowCoordinates[0] - windingWindowWidth / 2,
+                                                        windingWindowCoordinates[0] + windingWindowWidth / 2,
+                                                        windingWindowCoordinates[1] - windingWindowHeight / 2,
+                                                        windingWindowCoordinates[1] + windingWindowHeight / 2,
+                                                        mirroringDimension.value());
+        };
+        MKFNET_NAMED_TIMER(magneticFieldTimer, "magneticField");
+        MKFNetInternal::calculate_magnetic_field_strength(mirrorSources(sources), pointsX.data(), pointsY.data(), pointsX.size(), fieldX.data(), fieldY.data(), instructionSet, pool? &pool.value() : nullptr);
+        if (hasQuadratureCurrent) {
+            MKFNetInternal::calculate_magnetic_field_strength(mirrorSources(quadratureSources), pointsX.data(), pointsY.data(), pointsX.size(), quadratureFieldX.data(), quadratureFieldY.data(), instructionSet, pool? &pool.value() : nullptr);
+        }
+        else {
+            std::fill(quadratureFieldX.begin(), quadratureFieldX.end(), 0);
+            std::fill(quadratureFieldY.begin(), quadratureFieldY.end(), 0);
+        }
+        magneticFieldTimer.stop();
+
+        std::vector<OpenMagnetics::ComplexFieldPoint> fieldPoints;
+        fieldPoints.reserve(pointsX.size());
+        for (size_t pointIndex = 0; pointIndex < pointsX.size(); pointIndex++) {
+            OpenMagnetics::ComplexFieldPoint fieldPoint;
+            fieldPoint.set_point({pointsX[pointIndex], pointsY[pointIndex]});
+            // Each component is the amplitude of its phasor, signed like its in-phase part, which keeps the
+            // field magnitude that proximity losses use
+            fieldPoint.set_real(std::copysign(std::hypot(fieldX[pointIndex], quadratureFieldX[pointIndex]), fieldX[pointIndex]));
+            fieldPoint.set_imaginary(std::copysign(std::hypot(fieldY[pointIndex], quadratureFieldY[pointIndex]), fieldY[pointIndex]));
+            if (!useGrid) {
+                fieldPoint.set_turn_index(pointIndex);
+                fieldPoint.set_turn_length(turnTable.length[pointIndex]);
+            }
+            fieldPoints.push_back(fieldPoint);
+        }
+        OpenMagnetics::ComplexField field;
+        field.set_data(fieldPoints);
+        field.set_frequency(frequencies[harmonicIndex]);
+        fieldPerFrequency.push_back(field);
+    }
+
+    OpenMagnetics::WindingWindowMagneticStrengthFieldOutput windingWindowMagneticStrengthFieldOutput;
+    windingWindowMagneticStrengthFieldOutput.set_field_per_frequency(fieldPerFrequency);
+    windingWindowMagneticStrengthFieldOutput.set_method_used("MirroredStraightConductors");
+    windingWindowMagneticStrengthFieldOutput.set_origin(OpenMagnetics::ResultOrigin::SIMULATION);
+    return windingWindowMagneticStrengthFieldOutput;
+}
+
+std::string MKFNet::CalculateWindingWindowMagneticStrengthField(std::string operatingPointString, std::string magneticString, int numberPointsX, int numberPointsY) {
+    MKFNET_SCOPED_TIMER("CalculateWindingWindowMagneticStrengthField");
     try {
-        OpenMagnetics::MagneticWrapper magnetic(json::parse(magneticString));
-        OpenMagnetics::OperatingPoint operatingPoint(json::parse(operatingPointString));
-        OpenMagnetics::MagneticField magneticField;
+        OpenMagnetics::MagneticWrapper magnetic;
+        OpenMagnetics::OperatingPoint operatingPoint;
+        if (magneticString.starts_with("{")) {
+            magnetic = OpenMagnetics::MagneticWrapper(parseJson(magneticString));
+        }
+        else {
+            magnetic = getStoredMas(magneticString).get_magnetic();
+        }
+        if (operatingPointString.starts_with("{")) {
+            operatingPoint = OpenMagnetics::OperatingPoint(parseJson(operatingPointString));
+        }
+        else {
+            size_t operatingPointIndex = stoi(operatingPointString);
+            operatingPoint = getStoredMas(magneticString).get_inputs().get_operating_points()[operatingPointIndex];
+        }
 
-        auto windingWindowMagneticStrengthFieldOutput = magneticField.calculate_magnetic_field_strength_field(operatingPoint, magnetic);
+        auto turnTable = getTurnTable(magneticString, magnetic);
+        // Calls already running on a worker keep to their thread, the rest may use every core
+        size_t numberThreads = MKFNetInternal::ThreadPool::is_worker_thread()? 1 : 0;
+        auto windingWindowMagneticStrengthFieldOutput = calculateWindingWindowMagneticStrengthField(*turnTable, magnetic, operatingPoint, std::max(0, numberPointsX), std::max(0, numberPointsY), numberThreads);
 
         json result;
         to_json(result, windingWindowMagneticStrengthFieldOutput);
-        return result.dump(4);
+        return dumpJson(result);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+// The kernel sums the same straight-conductor field MKF uses for round and litz turns. Other conductors, and the
+// fringing of real gaps when it is included, are only modelled by MKF
+bool isFieldKernelApplicable(OpenMagnetics::MagneticWrapper& magnetic, bool includeFringing) {
+    auto& coil = magnetic.get_mutable_coil();
+    if (!coil.get_turns_description()) {
+        return false;
+    }
+    for (auto& wire : coil.get_wires()) {
+        if (wire.get_type() != OpenMagnetics::WireType::ROUND && wire.get_type() != OpenMagnetics::WireType::LITZ) {
+            return false;
+        }
+    }
+    if (includeFringing) {
+        for (auto& gap : magnetic.get_core().get_functional_description().get_gapping()) {
+            if (gap.get_type() != OpenMagnetics::GapType::RESIDUAL) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::string MKFNet::CalculateMagneticFieldStrengthField(std::string operatingPointString, std::string magneticString) {
+    MKFNET_SCOPED_TIMER("CalculateMagneticFieldStrengthField");
+    try {
+        auto settings = OpenMagnetics::Settings::GetInstance();
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
+        OpenMagnetics::OperatingPoint operatingPoint(parseJson(operatingPointString));
+
+        OpenMagnetics::WindingWindowMagneticStrengthFieldOutput windingWindowMagneticStrengthFieldOutput;
+        if (isFieldKernelApplicable(magnetic, settings->get_magnetic_field_include_fringing())) {
+            auto turnTable = MKFNetInternal::build_turn_table(magnetic.get_mutable_coil());
+            size_t numberThreads = MKFNetInternal::ThreadPool::is_worker_thread()? 1 : 0;
+            windingWindowMagneticStrengthFieldOutput = calculateWindingWindowMagneticStrengthField(turnTable, magnetic, operatingPoint, 0, 0, numberThreads, std::nullopt, WindingCurrentSigns::MAGNETIC_FIELD_DIRECTIONS);
+        }
+        else {
+            OpenMagnetics::MagneticField magneticField;
+            MKFNET_NAMED_TIMER(magneticFieldTimer, "magneticField");
+            windingWindowMagneticStrengthFieldOutput = magneticField.calculate_magnetic_field_strength_field(operatingPoint, magnetic);
+            magneticFieldTimer.stop();
+        }
+
+        json result;
+        to_json(result, windingWindowMagneticStrengthFieldOutput);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1124,16 +2321,17 @@ std::string MKFNet::CalculateMagneticFieldStrengthField(std::string operatingPoi
 }
 
 std::string MKFNet::CalculateProximityEffectLosses(std::string coilString, double temperature, std::string windingLossesOutputString, std::string windingWindowMagneticStrengthFieldOutputString) {
+    MKFNET_SCOPED_TIMER("CalculateProximityEffectLosses");
     try {
-        OpenMagnetics::CoilWrapper coil(json::parse(coilString));
-        OpenMagnetics::WindingLossesOutput windingLossesOutput(json::parse(windingLossesOutputString));
-        OpenMagnetics::WindingWindowMagneticStrengthFieldOutput windingWindowMagneticStrengthFieldOutput(json::parse(windingWindowMagneticStrengthFieldOutputString));
+        OpenMagnetics::CoilWrapper coil(parseJson(coilString));
+        OpenMagnetics::WindingLossesOutput windingLossesOutput(parseJson(windingLossesOutputString));
+        OpenMagnetics::WindingWindowMagneticStrengthFieldOutput windingWindowMagneticStrengthFieldOutput(parseJson(windingWindowMagneticStrengthFieldOutputString));
 
         auto windingLossesOutputOutput = OpenMagnetics::WindingProximityEffectLosses::calculate_proximity_effect_losses(coil, temperature, windingLossesOutput, windingWindowMagneticStrengthFieldOutput);
 
         json result;
         to_json(result, windingLossesOutputOutput);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1141,14 +2339,15 @@ std::string MKFNet::CalculateProximityEffectLosses(std::string coilString, doubl
 }
 
 std::string MKFNet::CalculateSkinEffectLosses(std::string coilString, std::string windingLossesOutputString, double temperature) {
+    MKFNET_SCOPED_TIMER("CalculateSkinEffectLosses");
     try {
-        OpenMagnetics::CoilWrapper coil(json::parse(coilString));
-        OpenMagnetics::WindingLossesOutput windingLossesOutput(json::parse(windingLossesOutputString));
+        OpenMagnetics::CoilWrapper coil(parseJson(coilString));
+        OpenMagnetics::WindingLossesOutput windingLossesOutput(parseJson(windingLossesOutputString));
 
         auto windingLossesOutputOutput = OpenMagnetics::WindingSkinEffectLosses::calculate_skin_effect_losses(coil, temperature, windingLossesOutput);
         json result;
         to_json(result, windingLossesOutputOutput);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1156,14 +2355,178 @@ std::string MKFNet::CalculateSkinEffectLosses(std::string coilString, std::strin
 }
 
 std::string MKFNet::CalculateSkinEffectLossesPerMeter(std::string wireString, std::string currentString, double temperature, double currentDivider) {
+    MKFNET_SCOPED_TIMER("CalculateSkinEffectLossesPerMeter");
     try {
-        OpenMagnetics::WireWrapper wire(json::parse(wireString));
-        OpenMagnetics::SignalDescriptor current(json::parse(currentString));
+        OpenMagnetics::WireWrapper wire(parseJson(wireString));
+        OpenMagnetics::SignalDescriptor current(parseJson(currentString));
+
+        if (!current.get_harmonics()) {
+            auto skinEffectLossesPerMeter = OpenMagnetics::WindingSkinEffectLosses::calculate_skin_effect_losses_per_meter(wire, current, temperature, currentDivider);
+            json result = skinEffectLossesPerMeter;
+            return dumpJson(result);
+        }
 
-        auto skinEffectLossesPerMeter = OpenMagnetics::WindingSkinEffectLosses::calculate_skin_effect_losses_per_meter(wire, current, temperature, currentDivider);
+        // Losses of each harmonic scale with its squared amplitude, so only the per-ampere value needs the wire model,
+        // and that comes from a table shared with every other call using the same wire and temperature
+        auto harmonics = current.get_harmonics().value();
+        auto& skinEffectTables = MKFNetInternal::SkinEffectTableCache::get_instance();
+        auto wireKey = MKFNetInternal::SkinEffectTableCache::get_wire_key(wire);
+        decltype(OpenMagnetics::WindingSkinEffectLosses::calculate_skin_effect_losses_per_meter(wire, current, temperature, currentDivider)) skinEffectLossesPerMeter;
+        skinEffectLossesPerMeter.first = 0;
+        for (size_t harmonicIndex = 0; harmonicIndex < harmonics.get_amplitudes().size(); harmonicIndex++) {
+            double amplitude = harmonics.get_amplitudes()[harmonicIndex] / currentDivider;
+            double frequency = harmonics.get_frequencies()[harmonicIndex];
+            double harmonicLosses = amplitude * amplitude * skinEffectTables.get_losses_per_meter_per_squared_ampere(wire, wireKey, frequency, temperature);
+            skinEffectLossesPerMeter.first += harmonicLosses;
+            skinEffectLossesPerMeter.second.push_back({harmonicLosses, frequency});
+        }
 
         json result = skinEffectLossesPerMeter;
-        return result.dump(4);
+        return dumpJson(result);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+void MKFNet::ClearSkinEffectTables() {
+    MKFNET_SCOPED_TIMER("ClearSkinEffectTables");
+    MKFNetInternal::SkinEffectTableCache::get_instance().clear();
+}
+
+struct WireCandidate {
+    OpenMagnetics::WireWrapper wire;
+    double lossesPerMeter;
+    double conductingArea;
+    double outerWidth;
+    double outerHeight;
+    double fillingFactor;
+    double currentDensity;
+    size_t numberStrands;
+    double score = 0;
+};
+
+std::string MKFNet::CalculateAdvisedWires(std::string excitationString, double temperature, std::string constraintsString, int maximumNumberResults, int numberThreads) {
+    MKFNET_SCOPED_TIMER("CalculateAdvisedWires");
+    try {
+        OpenMagnetics::OperatingPointExcitation excitation;
+        OpenMagnetics::from_json(parseJson(excitationString), excitation);
+        auto current = excitation.get_current().value();
+        if (!current.get_harmonics()) {
+            auto sampledWaveform = OpenMagnetics::InputsWrapper::calculate_sampled_waveform(current.get_waveform().value(), excitation.get_frequency());
+            current.set_harmonics(OpenMagnetics::InputsWrapper::calculate_harmonics_data(sampledWaveform, excitation.get_frequency()));
+        }
+        auto harmonics = current.get_harmonics().value();
+        double rms = 0;
+        for (size_t harmonicIndex = 0; harmonicIndex < harmonics.get_amplitudes().size(); harmonicIndex++) {
+            double amplitude = harmonics.get_amplitudes()[harmonicIndex];
+            rms += harmonics.get_frequencies()[harmonicIndex] > 0? amplitude * amplitude / 2 : amplitude * amplitude;
+        }
+        rms = std::sqrt(rms);
+
+        json constraints = parseJson(constraintsString);
+        int64_t numberTurns = constraints.value("numberTurns", 1);
+        int64_t numberParallels = constraints.value("numberParallels", 1);
+        double windingWindowArea = constraints.value("windingWindowArea", 0.0);
+        double maximumFillingFactor = constraints.value("maximumFillingFactor", 1.0);
+        double maximumOuterWidth = constraints.value("maximumOuterWidth", std::numeric_limits<double>::infinity());
+        double maximumOuterHeight = constraints.value("maximumOuterHeight", std::numeric_limits<double>::infinity());
+        double maximumCurrentDensity = constraints.value("maximumCurrentDensity", std::numeric_limits<double>::infinity());
+        json weights = constraints.value("weights", json::object());
+        double lossesWeight = weights.value("losses", 1.0);
+        double areaWeight = weights.value("area", 0.5);
+        double costWeight = weights.value("cost", 0.5);
+
+        auto wires = OpenMagnetics::get_wires();
+        auto& skinEffectTables = MKFNetInternal::SkinEffectTableCache::get_instance();
+        std::vector<std::future<std::optional<WireCandidate>>> evaluations;
+        MKFNetInternal::ThreadPool pool(std::max(0, numberThreads));
+        for (auto& wire : wires) {
+            evaluations.push_back(pool.submit([&, wire]() mutable -> std::optional<WireCandidate> {
+                try {
+                    auto [outerWidth, outerHeight] = MKFNetInternal::get_wire_outer_dimensions(wire);
+                    if (outerWidth > maximumOuterWidth || outerHeight > maximumOuterHeight) {
+                        return std::nullopt;
+                    }
+                    double fillingFactor = 0;
+                    if (windingWindowArea > 0) {
+                        fillingFactor = numberTurns * numberParallels * outerWidth * outerHeight / windingWindowArea;
+                        if (fillingFactor > maximumFillingFactor) {
+                            return std::nullopt;
+                        }
+                    }
+                    double conductingArea = MKFNetInternal::get_wire_conducting_area(wire);
+                    double currentDensity = rms / (numberParallels * conductingArea);
+                    if (currentDensity > maximumCurrentDensity) {
+                        return std::nullopt;
+                    }
+
+                    // Each parallel carries its share of the current
+                    auto wireKey = MKFNetInternal::SkinEffectTableCache::get_wire_key(wire);
+                    double lossesPerMeter = 0;
+                    for (size_t harmonicIndex = 0; harmonicIndex < harmonics.get_amplitudes().size(); harmonicIndex++) {
+                        double amplitude = harmonics.get_amplitudes()[harmonicIndex] / numberParallels;
+                        lossesPerMeter += amplitude * amplitude * skinEffectTables.get_losses_per_meter_per_squared_ampere(wire, wireKey, harmonics.get_frequencies()[harmonicIndex], temperature);
+                    }
+                    lossesPerMeter *= numberParallels;
+
+                    size_t numberStrands = wire.get_type() == OpenMagnetics::WireType::LITZ? size_t(wire.get_number_conductors().value()) : 1;
+                    return WireCandidate{wire, lossesPerMeter, conductingArea, outerWidth, outerHeight, fillingFactor, currentDensity, numberStrands * numberParallels};
+                }
+                catch (...) {
+                    return std::nullopt;
+                }
+            }));
+        }
+
+        std::vector<WireCandidate> validCandidates;
+        for (auto& evaluation : evaluations) {
+            auto candidate = evaluation.get();
+            if (candidate) {
+                validCandidates.push_back(std::move(candidate.value()));
+            }
+        }
+        if (validCandidates.empty()) {
+            return dumpJson(json::array());
+        }
+
+        // Each criterion is scored relative to the best candidate on it; the number of strands stands in for manufacturing cost,
+        // as the catalog carries no prices
+        double lowestLosses = std::numeric_limits<double>::infinity();
+        double lowestArea = std::numeric_limits<double>::infinity();
+        double lowestNumberStrands = std::numeric_limits<double>::infinity();
+        for (auto& candidate : validCandidates) {
+            lowestLosses = std::min(lowestLosses, candidate.lossesPerMeter);
+            lowestArea = std::min(lowestArea, candidate.outerWidth * candidate.outerHeight);
+            lowestNumberStrands = std::min(lowestNumberStrands, double(candidate.numberStrands));
+        }
+        for (auto& candidate : validCandidates) {
+            candidate.score = lossesWeight * candidate.lossesPerMeter / std::max(lowestLosses, 1e-30) +
+                              areaWeight * candidate.outerWidth * candidate.outerHeight / lowestArea +
+                              costWeight * std::log2(1 + candidate.numberStrands / lowestNumberStrands);
+        }
+
+        size_t numberResults = std::min(validCandidates.size(), size_t(std::max(1, maximumNumberResults)));
+        std::partial_sort(validCandidates.begin(), validCandidates.begin() + numberResults, validCandidates.end(), [](const WireCandidate& a, const WireCandidate& b) {
+            return a.score < b.score;
+        });
+
+        json results = json::array();
+        for (size_t candidateIndex = 0; candidateIndex < numberResults; candidateIndex++) {
+            auto& candidate = validCandidates[candidateIndex];
+            json result;
+            to_json(result["wire"], candidate.wire);
+            result["lossesPerMeter"] = candidate.lossesPerMeter;
+            result["conductingArea"] = candidate.conductingArea;
+            result["outerWidth"] = candidate.outerWidth;
+            result["outerHeight"] = candidate.outerHeight;
+            result["fillingFactor"] = candidate.fillingFactor;
+            result["currentDensity"] = candidate.currentDensity;
+            result["numberStrands"] = candidate.numberStrands;
+            result["score"] = candidate.score;
+            results.push_back(result);
+        }
+        return dumpJson(results);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1171,6 +2534,7 @@ std::string MKFNet::CalculateSkinEffectLossesPerMeter(std::string wireString, st
 }
 
 double MKFNet::GetOuterDiameterEnameledRound(double conductingDiameter, int grade, std::string standardString) {
+    MKFNET_SCOPED_TIMER("GetOuterDiameterEnameledRound");
     try {
         OpenMagnetics::WireStandard standard;
         if (bool(magic_enum::enum_cast<OpenMagnetics::WireStandard>(standardString))) {
@@ -1189,6 +2553,7 @@ double MKFNet::GetOuterDiameterEnameledRound(double conductingDiameter, int grad
     }
 }
 double MKFNet::GetOuterDiameterInsulatedRound(double conductingDiameter, int numberLayers, double thicknessLayers, std::string standardString){
+    MKFNET_SCOPED_TIMER("GetOuterDiameterInsulatedRound");
     try {
         OpenMagnetics::WireStandard standard;
         if (bool(magic_enum::enum_cast<OpenMagnetics::WireStandard>(standardString))) {
@@ -1207,6 +2572,7 @@ double MKFNet::GetOuterDiameterInsulatedRound(double conductingDiameter, int num
     }
 }
 double MKFNet::GetOuterDiameterServedLitz(double conductingDiameter, int numberConductors, int grade, int numberLayers, std::string standardString){
+    MKFNET_SCOPED_TIMER("GetOuterDiameterServedLitz");
     try {
         OpenMagnetics::WireStandard standard;
         if (bool(magic_enum::enum_cast<OpenMagnetics::WireStandard>(standardString))) {
@@ -1225,6 +2591,7 @@ double MKFNet::GetOuterDiameterServedLitz(double conductingDiameter, int numberC
     }
 }
 double MKFNet::GetOuterDiameterInsulatedLitz(double conductingDiameter, int numberConductors, int numberLayers, double thicknessLayers, int grade, std::string standardString){
+    MKFNET_SCOPED_TIMER("GetOuterDiameterInsulatedLitz");
     try {
         OpenMagnetics::WireStandard standard;
         if (bool(magic_enum::enum_cast<OpenMagnetics::WireStandard>(standardString))) {
@@ -1243,6 +2610,7 @@ double MKFNet::GetOuterDiameterInsulatedLitz(double conductingDiameter, int numb
     }
 }
 double MKFNet::GetConductingAreaRectangular(double conductingWidth, double conductingHeight, std::string standardString){
+    MKFNET_SCOPED_TIMER("GetConductingAreaRectangular");
     try {
         OpenMagnetics::WireStandard standard;
         if (bool(magic_enum::enum_cast<OpenMagnetics::WireStandard>(standardString))) {
@@ -1262,6 +2630,7 @@ double MKFNet::GetConductingAreaRectangular(double conductingWidth, double condu
 }
 
 double MKFNet::GetOuterWidthRectangular(double conductingWidth, int grade, std::string standardString){
+    MKFNET_SCOPED_TIMER("GetOuterWidthRectangular");
     try {
         OpenMagnetics::WireStandard standard;
         if (bool(magic_enum::enum_cast<OpenMagnetics::WireStandard>(standardString))) {
@@ -1281,6 +2650,7 @@ double MKFNet::GetOuterWidthRectangular(double conductingWidth, int grade, std::
 }
 
 double MKFNet::GetOuterHeightRectangular(double conductingHeight, int grade, std::string standardString){
+    MKFNET_SCOPED_TIMER("GetOuterHeightRectangular");
     try {
         OpenMagnetics::WireStandard standard;
         if (bool(magic_enum::enum_cast<OpenMagnetics::WireStandard>(standardString))) {
@@ -1300,25 +2670,26 @@ double MKFNet::GetOuterHeightRectangular(double conductingHeight, int grade, std
 }
 
 double MKFNet::CalculateCoreMaximumMagneticEnergy(std::string coreDataString, std::string operatingPointString){
+    MKFNET_SCOPED_TIMER("CalculateCoreMaximumMagneticEnergy");
     try {
         OpenMagnetics::CoreWrapper core;
         OpenMagnetics::OperatingPoint operatingPoint;
         if (coreDataString.starts_with("{")) {
-            core = OpenMagnetics::CoreWrapper(json::parse(coreDataString), false, false, false);
+            core = OpenMagnetics::CoreWrapper(parseJson(coreDataString), false, false, false);
             if (!core.get_processed_description()) {
                 core.process_data();
                 core.process_gap();
             }
         }
         else {
-            core = masDatabase[coreDataString].get_magnetic().get_core();
+            core = getStoredMas(coreDataString).get_magnetic().get_core();
         }
         if (operatingPointString.starts_with("{")) {
-            operatingPoint = OpenMagnetics::OperatingPoint(json::parse(operatingPointString));
+            operatingPoint = OpenMagnetics::OperatingPoint(parseJson(operatingPointString));
         }
         else {
             size_t operatingPointIndex = stoi(operatingPointString);
-            operatingPoint = masDatabase[coreDataString].get_inputs().get_operating_points()[operatingPointIndex];
+            operatingPoint = getStoredMas(coreDataString).get_inputs().get_operating_points()[operatingPointIndex];
         }
         auto magneticEnergy = OpenMagnetics::MagneticEnergy({});
 
@@ -1338,8 +2709,9 @@ double MKFNet::CalculateCoreMaximumMagneticEnergy(std::string coreDataString, st
 }
 
 double MKFNet::CalculateRequiredMagneticEnergy(std::string inputsString){
+    MKFNET_SCOPED_TIMER("CalculateRequiredMagneticEnergy");
     try {
-        OpenMagnetics::InputsWrapper inputs(json::parse(inputsString));
+        OpenMagnetics::InputsWrapper inputs(parseJson(inputsString));
         auto magneticEnergy = OpenMagnetics::MagneticEnergy({});
         auto requiredMagneticEnergy = magneticEnergy.calculate_required_magnetic_energy(inputs);
         return OpenMagnetics::resolve_dimensional_values(requiredMagneticEnergy);
@@ -1351,8 +2723,10 @@ double MKFNet::CalculateRequiredMagneticEnergy(std::string inputsString){
 }
 
 bool MKFNet::PlotCore(std::string magneticString, std::string outFile) {
+    MKFNET_SCOPED_TIMER("PlotCore");
     try {
-        OpenMagnetics::MagneticWrapper magnetic(json::parse(magneticString));
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
+        std::lock_guard<std::mutex> lock(painterMutex);
         OpenMagnetics::Painter painter(outFile);
         painter.paint_core(magnetic);
         painter.paint_bobbin(magnetic);
@@ -1365,8 +2739,10 @@ bool MKFNet::PlotCore(std::string magneticString, std::string outFile) {
 }
 
 bool MKFNet::PlotSections(std::string magneticString, std::string outFile) {
+    MKFNET_SCOPED_TIMER("PlotSections");
     try {
-        OpenMagnetics::MagneticWrapper magnetic(json::parse(magneticString));
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
+        std::lock_guard<std::mutex> lock(painterMutex);
         OpenMagnetics::Painter painter(outFile);
         painter.paint_core(magnetic);
         painter.paint_bobbin(magnetic);
@@ -1380,8 +2756,10 @@ bool MKFNet::PlotSections(std::string magneticString, std::string outFile) {
 }
 
 bool MKFNet::PlotLayers(std::string magneticString, std::string outFile) {
+    MKFNET_SCOPED_TIMER("PlotLayers");
     try {
-        OpenMagnetics::MagneticWrapper magnetic(json::parse(magneticString));
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
+        std::lock_guard<std::mutex> lock(painterMutex);
         OpenMagnetics::Painter painter(outFile);
         painter.paint_core(magnetic);
         painter.paint_bobbin(magnetic);
@@ -1395,8 +2773,10 @@ bool MKFNet::PlotLayers(std::string magneticString, std::string outFile) {
 }
 
 bool MKFNet::PlotTurns(std::string magneticString, std::string outFile) {
+    MKFNET_SCOPED_TIMER("PlotTurns");
     try {
-        OpenMagnetics::MagneticWrapper magnetic(json::parse(magneticString));
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
+        std::lock_guard<std::mutex> lock(painterMutex);
         OpenMagnetics::Painter painter(outFile);
         painter.paint_core(magnetic);
         painter.paint_bobbin(magnetic);
@@ -1409,14 +2789,35 @@ bool MKFNet::PlotTurns(std::string magneticString, std::string outFile) {
     }
 }
 
-bool MKFNet::PlotField(std::string magneticString, std::string operatingPointString, std::string outFile) {
-    try {
-        auto settings = OpenMagnetics::Settings::GetInstance();
-        OpenMagnetics::MagneticWrapper magnetic(json::parse(magneticString));
-        OpenMagnetics::OperatingPoint operatingPoint(json::parse(operatingPointString));
-        OpenMagnetics::Painter painter(outFile);
-        painter.paint_magnetic_field(operatingPoint, magnetic);
-        painter.paint_core(magnetic);
+// Painter draws the fundamental, its harmonic 1, of a field it is given as is, so that field comes from the turn table
+// and the kernel over the painter grid wherever the kernel applies. Callers hold painterMutex
+void paintMagneticField(OpenMagnetics::Painter& painter, OpenMagnetics::OperatingPoint& operatingPoint, OpenMagnetics::MagneticWrapper& magnetic) {
+    auto settings = OpenMagnetics::Settings::GetInstance();
+    if (isFieldKernelApplicable(magnetic, settings->get_painter_include_fringing())) {
+        auto turnTable = MKFNetInternal::build_turn_table(magnetic.get_mutable_coil());
+        size_t numberThreads = MKFNetInternal::ThreadPool::is_worker_thread()? 1 : 0;
+        auto windingWindowMagneticStrengthFieldOutput = calculateWindingWindowMagneticStrengthField(turnTable, magnetic, operatingPoint, settings->get_painter_number_points_x(), settings->get_painter_number_points_y(), numberThreads, settings->get_painter_mirroring_dimension(), WindingCurrentSigns::MAGNETIC_FIELD_DIRECTIONS);
+        double fundamentalFrequency = operatingPoint.get_excitations_per_winding()[0].get_frequency();
+        for (auto& field : windingWindowMagneticStrengthFieldOutput.get_field_per_frequency()) {
+            if (field.get_frequency() == fundamentalFrequency) {
+                painter.paint_magnetic_field(operatingPoint, magnetic, 1, field);
+                return;
+            }
+        }
+    }
+    painter.paint_magnetic_field(operatingPoint, magnetic);
+}
+
+bool MKFNet::PlotField(std::string magneticString, std::string operatingPointString, std::string outFile) {
+    MKFNET_SCOPED_TIMER("PlotField");
+    try {
+        auto settings = OpenMagnetics::Settings::GetInstance();
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
+        OpenMagnetics::OperatingPoint operatingPoint(parseJson(operatingPointString));
+        std::lock_guard<std::mutex> lock(painterMutex);
+        OpenMagnetics::Painter painter(outFile);
+        paintMagneticField(painter, operatingPoint, magnetic);
+        painter.paint_core(magnetic);
         painter.paint_bobbin(magnetic);
         painter.paint_coil_turns(magnetic);
         painter.export_svg();
@@ -1427,7 +2828,311 @@ bool MKFNet::PlotField(std::string magneticString, std::string operatingPointStr
     }
 }
 
+void paintMagnetic(OpenMagnetics::MagneticWrapper magnetic, std::string plotKind, std::optional<OpenMagnetics::OperatingPoint> operatingPoint, std::string outFile) {
+    std::transform(plotKind.begin(), plotKind.end(), plotKind.begin(), ::tolower);
+    if (plotKind != "core" && plotKind != "sections" && plotKind != "layers" && plotKind != "turns" && plotKind != "field") {
+        throw std::invalid_argument("Unknown plot kind: " + plotKind);
+    }
+    if (plotKind == "field" && !operatingPoint) {
+        throw std::invalid_argument("Field plots need an operating point");
+    }
+
+    // Painter draws through matplot++, whose current figure is global state
+    std::lock_guard<std::mutex> lock(painterMutex);
+    OpenMagnetics::Painter painter(outFile);
+    if (plotKind == "field") {
+        paintMagneticField(painter, operatingPoint.value(), magnetic);
+    }
+    painter.paint_core(magnetic);
+    painter.paint_bobbin(magnetic);
+    if (plotKind == "sections") {
+        painter.paint_coil_sections(magnetic);
+    }
+    else if (plotKind == "layers") {
+        painter.paint_coil_layers(magnetic);
+    }
+    else if (plotKind == "turns" || plotKind == "field") {
+        painter.paint_coil_turns(magnetic);
+    }
+    painter.export_svg();
+}
+
+std::string MKFNet::PlotBatch(std::string plotJobsString, int numberThreads) {
+    MKFNET_SCOPED_TIMER("PlotBatch");
+    try {
+        json plotJobsJson = parseJson(plotJobsString);
+        json magneticsJson = plotJobsJson.contains("magnetics")? plotJobsJson["magnetics"] : json::object();
+        json jobsJson = plotJobsJson["jobs"];
+
+        std::map<std::string, std::shared_future<OpenMagnetics::MagneticWrapper>> magnetics;
+        std::vector<std::future<std::string>> plots;
+        MKFNetInternal::ThreadPool pool(std::max(0, numberThreads));
+
+        // Each part is parsed once and shared by every plot kind requested for it
+        for (auto& [magneticKey, magneticJson] : magneticsJson.items()) {
+            magnetics[magneticKey] = pool.submit([&magneticJson = magneticJson]() {
+                return OpenMagnetics::MagneticWrapper(magneticJson);
+            }).share();
+        }
+
+        for (auto& jobJson : jobsJson) {
+            plots.push_back(pool.submit([&jobJson, &magnetics]() -> std::string {
+                try {
+                    std::string magneticKey = jobJson["magnetic"];
+                    OpenMagnetics::MagneticWrapper magnetic;
+                    std::optional<OpenMagnetics::OperatingPoint> operatingPoint;
+                    auto magneticIterator = magnetics.find(magneticKey);
+                    if (magneticIterator != magnetics.end()) {
+                        magnetic = magneticIterator->second.get();
+                    }
+                    else {
+                        magnetic = getStoredMas(magneticKey).get_magnetic();
+                    }
+                    if (jobJson.contains("operatingPoint")) {
+                        if (jobJson["operatingPoint"].is_object()) {
+                            operatingPoint = OpenMagnetics::OperatingPoint(jobJson["operatingPoint"]);
+                        }
+                        else {
+                            size_t operatingPointIndex = jobJson["operatingPoint"];
+                            operatingPoint = getStoredMas(magneticKey).get_inputs().get_operating_points()[operatingPointIndex];
+                        }
+                    }
+                    paintMagnetic(magnetic, jobJson["plot"], operatingPoint, jobJson["outFile"]);
+                    return "";
+                }
+                catch (const std::exception &exc) {
+                    return std::string{exc.what()};
+                }
+            }));
+        }
+
+        json results = json::array();
+        for (size_t jobIndex = 0; jobIndex < plots.size(); jobIndex++) {
+            auto error = plots[jobIndex].get();
+            json result;
+            result["outFile"] = jobsJson[jobIndex]["outFile"];
+            result["success"] = error.empty();
+            if (!error.empty()) {
+                result["error"] = error;
+            }
+            results.push_back(result);
+        }
+        return dumpJson(results);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+void paintMagneticFieldPreview(OpenMagnetics::MagneticWrapper magnetic, OpenMagnetics::OperatingPoint operatingPoint, std::string outFile, size_t maximumNumberPrimitives) {
+    auto coil = magnetic.get_coil();
+    if (!coil.get_turns_description()) {
+        throw std::invalid_argument("Field previews need a wound coil");
+    }
+    // Core, bobbin and margins, plus copper and insulation for each conductor drawn
+    const size_t numberFixedPrimitives = 16;
+    const size_t numberPrimitivesPerConductor = 2;
+    const size_t minimumNumberPointsPerDimension = 4;
+
+    size_t numberTurns = coil.get_turns_description()->size();
+    size_t numberLayers = coil.get_layers_description()? coil.get_layers_description()->size() : numberTurns;
+    size_t numberSections = coil.get_sections_description()? coil.get_sections_description()->size() : numberLayers;
+
+    // Conductors may use at most half of the budget, falling back to coarser coil views
+    std::string coilDetail = "turns";
+    size_t numberConductorPrimitives = numberTurns * numberPrimitivesPerConductor;
+    if (numberConductorPrimitives > maximumNumberPrimitives / 2) {
+        coilDetail = "layers";
+        numberConductorPrimitives = numberLayers * numberPrimitivesPerConductor;
+    }
+    if (numberConductorPrimitives > maximumNumberPrimitives / 2) {
+        coilDetail = "sections";
+        numberConductorPrimitives = numberSections * numberPrimitivesPerConductor;
+    }
+
+    size_t numberFieldPoints = 0;
+    if (maximumNumberPrimitives > numberFixedPrimitives + numberConductorPrimitives) {
+        numberFieldPoints = maximumNumberPrimitives - numberFixedPrimitives - numberConductorPrimitives;
+    }
+
+    auto bobbin = coil.resolve_bobbin();
+    auto windingWindow = bobbin.get_processed_description()->get_winding_windows()[0];
+    double aspectRatio = 1;
+    if (windingWindow.get_width() && windingWindow.get_height()) {
+        aspectRatio = windingWindow.get_width().value() / windingWindow.get_height().value();
+    }
+    // Very wide or tall windows still keep the minimum number of points across
+    size_t maximumNumberPointsX = std::max(minimumNumberPointsPerDimension, numberFieldPoints / minimumNumberPointsPerDimension);
+    size_t numberPointsX = std::clamp(size_t(std::sqrt(numberFieldPoints * aspectRatio)), minimumNumberPointsPerDimension, maximumNumberPointsX);
+    size_t numberPointsY = std::max(minimumNumberPointsPerDimension, numberFieldPoints / numberPointsX);
+    // Neither the coarsest coil view nor the smallest field grid shrinks any further, so a budget below them is refused
+    size_t numberPrimitives = numberFixedPrimitives + numberConductorPrimitives + numberPointsX * numberPointsY;
+    if (numberPrimitives > maximumNumberPrimitives) {
+        throw std::invalid_argument("A field preview needs at least " + std::to_string(numberPrimitives) + " primitives, over the budget of " + std::to_string(maximumNumberPrimitives));
+    }
+
+    // The painter grid is a global setting, so jobs reading the settings are held off until it is restored.
+    // settingsMutex is taken before painterMutex, the order plot jobs take them in
+    std::unique_lock<std::shared_mutex> settingsLock(settingsMutex);
+    std::lock_guard<std::mutex> lock(painterMutex);
+    auto settings = OpenMagnetics::Settings::GetInstance();
+    auto previousNumberPointsX = settings->get_painter_number_points_x();
+    auto previousNumberPointsY = settings->get_painter_number_points_y();
+    settings->set_painter_number_points_x(std::min<size_t>(numberPointsX, previousNumberPointsX));
+    settings->set_painter_number_points_y(std::min<size_t>(numberPointsY, previousNumberPointsY));
+    try {
+        OpenMagnetics::Painter painter(outFile);
+        paintMagneticField(painter, operatingPoint, magnetic);
+        painter.paint_core(magnetic);
+        painter.paint_bobbin(magnetic);
+        if (coilDetail == "turns") {
+            painter.paint_coil_turns(magnetic);
+        }
+        else if (coilDetail == "layers") {
+            painter.paint_coil_layers(magnetic);
+        }
+        else {
+            painter.paint_coil_sections(magnetic);
+        }
+        painter.export_svg();
+    }
+    catch (...) {
+        settings->set_painter_number_points_x(previousNumberPointsX);
+        settings->set_painter_number_points_y(previousNumberPointsY);
+        throw;
+    }
+    settings->set_painter_number_points_x(previousNumberPointsX);
+    settings->set_painter_number_points_y(previousNumberPointsY);
+}
+
+bool MKFNet::PlotFieldPreview(std::string magneticString, std::string operatingPointString, std::string outFile, int maximumNumberPrimitives) {
+    MKFNET_SCOPED_TIMER("PlotFieldPreview");
+    try {
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
+        OpenMagnetics::OperatingPoint operatingPoint(parseJson(operatingPointString));
+        paintMagneticFieldPreview(magnetic, operatingPoint, outFile, std::max(0, maximumNumberPrimitives));
+        return true;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+std::filesystem::path getTemporarySvgPath() {
+    static std::atomic<size_t> temporaryFileCounter = 0;
+    std::filesystem::path temporaryDirectory = std::filesystem::temp_directory_path();
+    // Prefer tmpfs so the round trip through Painter never touches a disk
+    if (std::filesystem::is_directory("/dev/shm")) {
+        temporaryDirectory = "/dev/shm";
+    }
+    // Worker processes share the directory, so the process id keeps their names apart
+#if defined(_WIN32)
+    auto processId = _getpid();
+#else
+    auto processId = getpid();
+#endif
+    auto threadHash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    auto fileName = "MKFNet_" + std::to_string(processId) + "_" + std::to_string(threadHash) + "_" + std::to_string(temporaryFileCounter++) + ".svg";
+    return temporaryDirectory / fileName;
+}
+
+std::string paintMagneticToString(OpenMagnetics::MagneticWrapper magnetic, std::string plotKind, std::optional<OpenMagnetics::OperatingPoint> operatingPoint) {
+    auto temporarySvgPath = getTemporarySvgPath();
+    try {
+        paintMagnetic(magnetic, plotKind, operatingPoint, temporarySvgPath.string());
+        std::ifstream svgFile(temporarySvgPath, std::ios::binary);
+        std::string svg{std::istreambuf_iterator<char>(svgFile), std::istreambuf_iterator<char>()};
+        svgFile.close();
+        std::filesystem::remove(temporarySvgPath);
+        return svg;
+    }
+    catch (...) {
+        std::error_code errorCode;
+        std::filesystem::remove(temporarySvgPath, errorCode);
+        throw;
+    }
+}
+
+std::string encodeBase64(const std::string& data) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string encoded;
+    encoded.reserve(((data.size() + 2) / 3) * 4);
+    size_t index = 0;
+    for (; index + 2 < data.size(); index += 3) {
+        uint32_t chunk = (uint8_t(data[index]) << 16) | (uint8_t(data[index + 1]) << 8) | uint8_t(data[index + 2]);
+        encoded.push_back(alphabet[(chunk >> 18) & 0x3F]);
+        encoded.push_back(alphabet[(chunk >> 12) & 0x3F]);
+        encoded.push_back(alphabet[(chunk >> 6) & 0x3F]);
+        encoded.push_back(alphabet[chunk & 0x3F]);
+    }
+    if (index < data.size()) {
+        uint32_t chunk = uint8_t(data[index]) << 16;
+        if (index + 1 < data.size()) {
+            chunk |= uint8_t(data[index + 1]) << 8;
+        }
+        encoded.push_back(alphabet[(chunk >> 18) & 0x3F]);
+        encoded.push_back(alphabet[(chunk >> 12) & 0x3F]);
+        encoded.push_back(index + 1 < data.size()? alphabet[(chunk >> 6) & 0x3F] : '=');
+        encoded.push_back('=');
+    }
+    return encoded;
+}
+
+std::string compressGzip(const std::string& data) {
+#ifdef MKFNET_HAVE_ZLIB
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("Could not initialize gzip compression");
+    }
+    std::string compressed(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+    stream.avail_out = compressed.size();
+    int status = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        throw std::runtime_error("Gzip compression failed");
+    }
+    compressed.resize(stream.total_out);
+    return compressed;
+#else
+    throw std::runtime_error("MKFNet was built without zlib, gzip output is not available");
+#endif
+}
+
+std::string MKFNet::PlotToString(std::string magneticString, std::string plotKind, std::string operatingPointString) {
+    MKFNET_SCOPED_TIMER("PlotToString");
+    try {
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
+        std::optional<OpenMagnetics::OperatingPoint> operatingPoint;
+        if (operatingPointString.starts_with("{")) {
+            operatingPoint = OpenMagnetics::OperatingPoint(parseJson(operatingPointString));
+        }
+        return paintMagneticToString(magnetic, plotKind, operatingPoint);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+std::string MKFNet::PlotToCompressedString(std::string magneticString, std::string plotKind, std::string operatingPointString) {
+    MKFNET_SCOPED_TIMER("PlotToCompressedString");
+    try {
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
+        std::optional<OpenMagnetics::OperatingPoint> operatingPoint;
+        if (operatingPointString.starts_with("{")) {
+            operatingPoint = OpenMagnetics::OperatingPoint(parseJson(operatingPointString));
+        }
+        return encodeBase64(compressGzip(paintMagneticToString(magnetic, plotKind, operatingPoint)));
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
 std::string MKFNet::GetSettings() {
+    MKFNET_SCOPED_TIMER("GetSettings");
     try {
         auto settings = OpenMagnetics::Settings::GetInstance();
         json settingsJson;
@@ -1459,7 +3164,7 @@ std::string MKFNet::GetSettings() {
         settingsJson["magneticFieldNumberPointsY"] = settings->get_magnetic_field_number_points_y();
         settingsJson["magneticFieldIncludeFringing"] = settings->get_magnetic_field_include_fringing();
         settingsJson["magneticFieldMirroringDimension"] = settings->get_magnetic_field_mirroring_dimension();
-        return settingsJson.dump(4);
+        return dumpJson(settingsJson);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1467,9 +3172,11 @@ std::string MKFNet::GetSettings() {
 }
 
 void MKFNet::SetSettings(std::string settingsString) {
+    MKFNET_SCOPED_TIMER("SetSettings");
     try {
+        std::unique_lock<std::shared_mutex> settingsLock(settingsMutex);
         auto settings = OpenMagnetics::Settings::GetInstance();
-        json settingsJson = json::parse(settingsString);
+        json settingsJson = parseJson(settingsString);
         settings->set_coil_allow_margin_tape(settingsJson["coilAllowMarginTape"] == 1);
         settings->set_coil_allow_insulated_wire(settingsJson["coilAllowInsulatedWire"] == 1);
         settings->set_coil_fill_sections_with_margin_tape(settingsJson["coilFillSectionsWithMarginTape"] == 1);
@@ -1505,19 +3212,222 @@ void MKFNet::SetSettings(std::string settingsString) {
 }
 
 void MKFNet::ResetSettings() {
+    MKFNET_SCOPED_TIMER("ResetSettings");
+    std::unique_lock<std::shared_mutex> settingsLock(settingsMutex);
     auto settings = OpenMagnetics::Settings::GetInstance();
     settings->reset();
 }
 
+std::shared_ptr<MKFNetInternal::JobSystem> jobSystem;
+MKFNetJobCallback* jobCallback = nullptr;
+std::mutex jobSystemMutex;
+
+std::shared_ptr<MKFNetInternal::JobSystem> createJobSystem(size_t numberWorkers, size_t queueCapacity) {
+    auto newJobSystem = std::make_shared<MKFNetInternal::JobSystem>(numberWorkers, queueCapacity);
+    newJobSystem->set_completion_callback([](int jobId, MKFNetInternal::JobStatus status, const std::string& result) {
+        MKFNetJobCallback* callback;
+        {
+            std::lock_guard<std::mutex> lock(jobSystemMutex);
+            callback = jobCallback;
+        }
+        if (callback) {
+            callback->OnJobFinished(jobId, std::string(magic_enum::enum_name(status)), result);
+        }
+    });
+    return newJobSystem;
+}
+
+std::shared_ptr<MKFNetInternal::JobSystem> getJobSystem() {
+    std::lock_guard<std::mutex> lock(jobSystemMutex);
+    if (!jobSystem) {
+        jobSystem = createJobSystem(0, 256);
+    }
+    return jobSystem;
+}
+
+// Jobs run on a fresh wrapper instance, so they never depend on the lifetime of the caller's one
+// Work that changes the settings takes settingsMutex exclusively by itself.
+// jobSystemMutex is held while submitting, so StartJobs cannot swap the system between the choice and the submission
+int submitJob(std::function<std::string()> work, bool changesSettings = false) {
+    std::lock_guard<std::mutex> jobSystemLock(jobSystemMutex);
+    if (!jobSystem) {
+        jobSystem = createJobSystem(0, 256);
+    }
+    auto jobId = jobSystem->submit([work = std::move(work), changesSettings]() {
+        std::string result;
+        if (changesSettings) {
+            result = work();
+        }
+        else {
+            std::shared_lock<std::shared_mutex> lock(settingsMutex);
+            result = work();
+        }
+        if (result.starts_with("Exception: ")) {
+            throw std::runtime_error(result.substr(std::string("Exception: ").size()));
+        }
+        return result;
+    });
+    return jobId? jobId.value() : -1;
+}
+
+bool MKFNet::StartJobs(int numberWorkers, int queueCapacity) {
+    MKFNET_SCOPED_TIMER("StartJobs");
+    try {
+        auto newJobSystem = createJobSystem(std::max(0, numberWorkers), std::max(1, queueCapacity));
+        std::shared_ptr<MKFNetInternal::JobSystem> previousJobSystem;
+        {
+            // Ids of the jobs a system holds are only known to it, so swapping it with jobs left would orphan them
+            std::lock_guard<std::mutex> lock(jobSystemMutex);
+            if (jobSystem && jobSystem->get_number_jobs() > 0) {
+                return false;
+            }
+            previousJobSystem = jobSystem;
+            jobSystem = newJobSystem;
+        }
+        // With no jobs left its workers are idle, so destroying it here only joins them. A completion callback never gets
+        // this far from one of those workers, as the job it reports is still held until released
+        previousJobSystem.reset();
+        return true;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+int MKFNet::SubmitSimulate(std::string inputsString, std::string magneticString, std::string modelsData) {
+    MKFNET_SCOPED_TIMER("SubmitSimulate");
+    return submitJob([inputsString, magneticString, modelsData]() {
+        return MKFNet().Simulate(inputsString, magneticString, modelsData);
+    });
+}
+
+int MKFNet::SubmitCalculateAdvisedCores(std::string inputsString, std::string weightsString, int maximumNumberResults, bool useOnlyCoresInStock) {
+    MKFNET_SCOPED_TIMER("SubmitCalculateAdvisedCores");
+    return submitJob([inputsString, weightsString, maximumNumberResults, useOnlyCoresInStock]() {
+        return MKFNet().CalculateAdvisedCores(inputsString, weightsString, maximumNumberResults, useOnlyCoresInStock);
+    }, true);
+}
+
+int MKFNet::SubmitCalculateAdvisedMagnetics(std::string inputsString, int maximumNumberResults) {
+    MKFNET_SCOPED_TIMER("SubmitCalculateAdvisedMagnetics");
+    return submitJob([inputsString, maximumNumberResults]() {
+        return MKFNet().CalculateAdvisedMagnetics(inputsString, maximumNumberResults);
+    });
+}
+
+std::pair<OpenMagnetics::MagneticWrapper, std::optional<OpenMagnetics::OperatingPoint>> resolvePlotInputs(std::string magneticString, std::string operatingPointString) {
+    OpenMagnetics::MagneticWrapper magnetic;
+    std::optional<OpenMagnetics::OperatingPoint> operatingPoint;
+    if (magneticString.starts_with("{")) {
+        magnetic = OpenMagnetics::MagneticWrapper(parseJson(magneticString));
+    }
+    else {
+        magnetic = getStoredMas(magneticString).get_magnetic();
+    }
+    if (operatingPointString.starts_with("{")) {
+        operatingPoint = OpenMagnetics::OperatingPoint(parseJson(operatingPointString));
+    }
+    else if (operatingPointString != "") {
+        size_t operatingPointIndex = stoi(operatingPointString);
+        operatingPoint = getStoredMas(magneticString).get_inputs().get_operating_points()[operatingPointIndex];
+    }
+    return {magnetic, operatingPoint};
+}
+
+int MKFNet::SubmitPlot(std::string magneticString, std::string plotKind, std::string operatingPointString, std::string outFile) {
+    MKFNET_SCOPED_TIMER("SubmitPlot");
+    return submitJob([magneticString, plotKind, operatingPointString, outFile]() {
+        auto [magnetic, operatingPoint] = resolvePlotInputs(magneticString, operatingPointString);
+        paintMagnetic(magnetic, plotKind, operatingPoint, outFile);
+        return outFile;
+    });
+}
+
+int MKFNet::SubmitPlotToString(std::string magneticString, std::string plotKind, std::string operatingPointString) {
+    MKFNET_SCOPED_TIMER("SubmitPlotToString");
+    return submitJob([magneticString, plotKind, operatingPointString]() {
+        auto [magnetic, operatingPoint] = resolvePlotInputs(magneticString, operatingPointString);
+        return paintMagneticToString(magnetic, plotKind, operatingPoint);
+    });
+}
+
+std::string MKFNet::PollJob(int jobId) {
+    MKFNET_SCOPED_TIMER("PollJob");
+    try {
+        return std::string(magic_enum::enum_name(getJobSystem()->poll(jobId).first));
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+std::string MKFNet::WaitJob(int jobId, int timeoutMilliseconds) {
+    MKFNET_SCOPED_TIMER("WaitJob");
+    try {
+        std::optional<std::chrono::milliseconds> timeout;
+        if (timeoutMilliseconds >= 0) {
+            timeout = std::chrono::milliseconds(timeoutMilliseconds);
+        }
+        return std::string(magic_enum::enum_name(getJobSystem()->wait(jobId, timeout).first));
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+std::string MKFNet::GetJobResult(int jobId) {
+    MKFNET_SCOPED_TIMER("GetJobResult");
+    try {
+        auto [status, result] = getJobSystem()->poll(jobId);
+        if (status == MKFNetInternal::JobStatus::FAILED) {
+            return "Exception: " + result;
+        }
+        if (status != MKFNetInternal::JobStatus::COMPLETED) {
+            return "Exception: Job " + std::to_string(jobId) + " is " + std::string(magic_enum::enum_name(status));
+        }
+        return result;
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+bool MKFNet::CancelJob(int jobId) {
+    MKFNET_SCOPED_TIMER("CancelJob");
+    try {
+        return getJobSystem()->cancel(jobId);
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+bool MKFNet::ReleaseJob(int jobId) {
+    MKFNET_SCOPED_TIMER("ReleaseJob");
+    try {
+        return getJobSystem()->release(jobId);
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+void MKFNet::SetJobCallback(MKFNetJobCallback* callback) {
+    MKFNET_SCOPED_TIMER("SetJobCallback");
+    std::lock_guard<std::mutex> lock(jobSystemMutex);
+    jobCallback = callback;
+}
+
 
 
 std::string MKFNet::CalculateInductanceAndMagneticFluxDensity(std::string coreData, std::string coilData, std::string operatingPointData, std::string modelsData){
+    MKFNET_SCOPED_TIMER("CalculateInductanceAndMagneticFluxDensity");
     try {
-        OpenMagnetics::CoreWrapper core(json::parse(coreData));
-        OpenMagnetics::CoilWrapper coil(json::parse(coilData));
-        OpenMagnetics::OperatingPoint operatingPoint(json::parse(operatingPointData));
+        OpenMagnetics::CoreWrapper core(parseJson(coreData));
+        OpenMagnetics::CoilWrapper coil(parseJson(coilData));
+        OpenMagnetics::OperatingPoint operatingPoint(parseJson(operatingPointData));
 
-        std::map<std::string, std::string> models = json::parse(modelsData).get<std::map<std::string, std::string>>();
+        std::map<std::string, std::string> models = parseJson(modelsData).get<std::map<std::string, std::string>>();
 
         auto reluctanceModelName = OpenMagnetics::Defaults().reluctanceModelDefault;
         if (models.find("reluctance") != models.end()) {
@@ -1536,7 +3446,7 @@ std::string MKFNet::CalculateInductanceAndMagneticFluxDensity(std::string coreDa
         to_json(magneticFluxDensityJson, magnetizingInductanceAndMagneticFluxDensity.second);
         result.push_back(magnetizingInductanceJson);
         result.push_back(magneticFluxDensityJson);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1545,11 +3455,12 @@ std::string MKFNet::CalculateInductanceAndMagneticFluxDensity(std::string coreDa
 
 
 std::string MKFNet::CalculateInductanceFromNumberTurnsAndGapping(std::string coreData, std::string coilData, std::string operatingPointData, std::string modelsData){
+    MKFNET_SCOPED_TIMER("CalculateInductanceFromNumberTurnsAndGapping");
     try {
-        OpenMagnetics::CoreWrapper core(json::parse(coreData));
-        OpenMagnetics::CoilWrapper coil(json::parse(coilData));
+        OpenMagnetics::CoreWrapper core(parseJson(coreData));
+        OpenMagnetics::CoilWrapper coil(parseJson(coilData));
 
-        std::map<std::string, std::string> models = json::parse(modelsData).get<std::map<std::string, std::string>>();
+        std::map<std::string, std::string> models = parseJson(modelsData).get<std::map<std::string, std::string>>();
 
         auto reluctanceModelName = OpenMagnetics::Defaults().reluctanceModelDefault;
         if (models.find("reluctance") != models.end()) {
@@ -1560,9 +3471,10 @@ std::string MKFNet::CalculateInductanceFromNumberTurnsAndGapping(std::string cor
 
         OpenMagnetics::MagnetizingInductance magnetizing_inductance(reluctanceModelName);
 
+        MKFNET_NAMED_TIMER(reluctanceTimer, "reluctance");
         OpenMagnetics::MagnetizingInductanceOutput magnetizingInductanceOutput;
         if (operatingPointData != "null") {
-            OpenMagnetics::OperatingPoint operatingPoint(json::parse(operatingPointData));
+            OpenMagnetics::OperatingPoint operatingPoint(parseJson(operatingPointData));
             if (operatingPoint.get_excitations_per_winding().size() == 0) {
                 magnetizingInductanceOutput = magnetizing_inductance.calculate_inductance_from_number_turns_and_gapping(core, coil, nullptr);
             }
@@ -1573,10 +3485,11 @@ std::string MKFNet::CalculateInductanceFromNumberTurnsAndGapping(std::string cor
         else {
             magnetizingInductanceOutput = magnetizing_inductance.calculate_inductance_from_number_turns_and_gapping(core, coil, nullptr);
         }
+        reluctanceTimer.stop();
 
         json result;
         to_json(result, magnetizingInductanceOutput);
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1585,11 +3498,12 @@ std::string MKFNet::CalculateInductanceFromNumberTurnsAndGapping(std::string cor
 
 
 int MKFNet::CalculateNumberTurnsFromGappingAndInductance(std::string coreData, std::string inputsData, std::string modelsData){
+    MKFNET_SCOPED_TIMER("CalculateNumberTurnsFromGappingAndInductance");
     try {
-        OpenMagnetics::CoreWrapper core(json::parse(coreData));
-        OpenMagnetics::InputsWrapper inputs(json::parse(inputsData));
+        OpenMagnetics::CoreWrapper core(parseJson(coreData));
+        OpenMagnetics::InputsWrapper inputs(parseJson(inputsData));
 
-        std::map<std::string, std::string> models = json::parse(modelsData).get<std::map<std::string, std::string>>();
+        std::map<std::string, std::string> models = parseJson(modelsData).get<std::map<std::string, std::string>>();
         
         auto reluctanceModelName = OpenMagnetics::Defaults().reluctanceModelDefault;
         if (models.find("reluctance") != models.end()) {
@@ -1610,16 +3524,17 @@ int MKFNet::CalculateNumberTurnsFromGappingAndInductance(std::string coreData, s
 
 
 std::string MKFNet::CalculateGappingFromNumberTurnsAndInductance(std::string coreData, std::string coilData, std::string inputsData, std::string gappingTypeString, int decimals, std::string modelsData){
+    MKFNET_SCOPED_TIMER("CalculateGappingFromNumberTurnsAndInductance");
     try {
-        OpenMagnetics::CoreWrapper core(json::parse(coreData));
-        OpenMagnetics::CoilWrapper coil(json::parse(coilData));
-        json inputsJson = json::parse(inputsData);
+        OpenMagnetics::CoreWrapper core(parseJson(coreData));
+        OpenMagnetics::CoilWrapper coil(parseJson(coilData));
+        json inputsJson = parseJson(inputsData);
         OpenMagnetics::InputsWrapper inputs;
         OpenMagnetics::from_json(inputsJson, inputs);
 
         std::transform(gappingTypeString.begin(), gappingTypeString.end(), gappingTypeString.begin(), ::toupper);
 
-        std::map<std::string, std::string> models = json::parse(modelsData).get<std::map<std::string, std::string>>();
+        std::map<std::string, std::string> models = parseJson(modelsData).get<std::map<std::string, std::string>>();
         OpenMagnetics::GappingType gappingType = magic_enum::enum_cast<OpenMagnetics::GappingType>(gappingTypeString).value();
         
         auto reluctanceModelName = OpenMagnetics::Defaults().reluctanceModelDefault;
@@ -1650,7 +3565,7 @@ std::string MKFNet::CalculateGappingFromNumberTurnsAndInductance(std::string cor
             to_json(aux, gap);
             result.push_back(aux);
         }
-        return result.dump(4);
+        return dumpJson(result);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1659,45 +3574,262 @@ std::string MKFNet::CalculateGappingFromNumberTurnsAndInductance(std::string cor
 
 
 
+void configureMagneticSimulator(OpenMagnetics::MagneticSimulator& magneticSimulator, std::string modelsString) {
+    auto defaults = OpenMagnetics::Defaults();
+    std::map<std::string, std::string> models = parseJson(modelsString).get<std::map<std::string, std::string>>();
+
+    auto reluctanceModelName = defaults.reluctanceModelDefault;
+    if (models.find("reluctance") != models.end()) {
+        std::string modelNameStringUpper = models["reluctance"];
+        std::transform(modelNameStringUpper.begin(), modelNameStringUpper.end(), modelNameStringUpper.begin(), ::toupper);
+        reluctanceModelName = magic_enum::enum_cast<OpenMagnetics::ReluctanceModels>(modelNameStringUpper).value();
+    }
+    auto coreLossesModelName = defaults.coreLossesModelDefault;
+    if (models.find("coreLosses") != models.end()) {
+        std::string modelNameStringUpper = models["coreLosses"];
+        std::transform(modelNameStringUpper.begin(), modelNameStringUpper.end(), modelNameStringUpper.begin(), ::toupper);
+        coreLossesModelName = magic_enum::enum_cast<OpenMagnetics::CoreLossesModels>(modelNameStringUpper).value();
+    }
+    auto coreTemperatureModelName = defaults.coreTemperatureModelDefault;
+    if (models.find("coreTemperature") != models.end()) {
+        std::string modelNameStringUpper = models["coreTemperature"];
+        std::transform(modelNameStringUpper.begin(), modelNameStringUpper.end(), modelNameStringUpper.begin(), ::toupper);
+        coreTemperatureModelName = magic_enum::enum_cast<OpenMagnetics::CoreTemperatureModels>(modelNameStringUpper).value();
+    }
+
+    magneticSimulator.set_core_losses_model_name(coreLossesModelName);
+    magneticSimulator.set_core_temperature_model_name(coreTemperatureModelName);
+    magneticSimulator.set_reluctance_model_name(reluctanceModelName);
+}
+
 std::string MKFNet::Simulate(std::string inputsString, std::string magneticString, std::string modelsData){
+    MKFNET_SCOPED_TIMER("Simulate");
     try {
-        OpenMagnetics::MagneticWrapper magnetic(json::parse(magneticString));
-        OpenMagnetics::InputsWrapper inputs(json::parse(inputsString));
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
+        OpenMagnetics::InputsWrapper inputs(parseJson(inputsString));
 
-        auto defaults = OpenMagnetics::Defaults();
+        OpenMagnetics::MagneticSimulator magneticSimulator;
+        configureMagneticSimulator(magneticSimulator, modelsData);
+        MKFNET_NAMED_TIMER(simulateTimer, "simulate");
+        auto mas = magneticSimulator.simulate(inputs, magnetic);
+        simulateTimer.stop();
 
-        std::map<std::string, std::string> models = json::parse(modelsData).get<std::map<std::string, std::string>>();
+        json result;
+        to_json(result, mas);
 
-        auto reluctanceModelName = defaults.reluctanceModelDefault;
-        if (models.find("reluctance") != models.end()) {
-            std::string modelNameStringUpper = models["reluctance"];
-            std::transform(modelNameStringUpper.begin(), modelNameStringUpper.end(), modelNameStringUpper.begin(), ::toupper);
-            reluctanceModelName = magic_enum::enum_cast<OpenMagnetics::ReluctanceModels>(modelNameStringUpper).value();
+        return dumpJson(result);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+// Sub-results of a simulation that a patch makes stale
+struct SimulationInvalidation {
+    bool magnetizingInductance = false;
+    bool coreLosses = false;
+    bool windingLosses = false;
+    bool coilLayout = false;
+    bool allOperatingPoints = false;
+    std::set<size_t> operatingPoints;
+    std::set<std::string> explicitCoilDescriptions;
+
+    void invalidate_all() {
+        magnetizingInductance = true;
+        coreLosses = true;
+        windingLosses = true;
+        coilLayout = true;
+        allOperatingPoints = true;
+    }
+};
+
+SimulationInvalidation getSimulationInvalidation(const json& patch) {
+    const std::string coilPath = "/magnetic/coil/";
+    const std::string operatingPointsPath = "/inputs/operatingPoints/";
+    SimulationInvalidation invalidation;
+    for (auto& operation : patch) {
+        std::string path = operation.at("path").get<std::string>();
+        if (operation.at("op") == "move" || operation.at("op") == "copy") {
+            invalidation.invalidate_all();
         }
-        auto coreLossesModelName = defaults.coreLossesModelDefault;
-        if (models.find("coreLosses") != models.end()) {
-            std::string modelNameStringUpper = models["coreLosses"];
-            std::transform(modelNameStringUpper.begin(), modelNameStringUpper.end(), modelNameStringUpper.begin(), ::toupper);
-            coreLossesModelName = magic_enum::enum_cast<OpenMagnetics::CoreLossesModels>(modelNameStringUpper).value();
+        else if (path.starts_with("/magnetic/core/functionalDescription/material")) {
+            invalidation.magnetizingInductance = true;
+            invalidation.coreLosses = true;
         }
-        auto coreTemperatureModelName = defaults.coreTemperatureModelDefault;
-        if (models.find("coreTemperature") != models.end()) {
-            std::string modelNameStringUpper = models["coreTemperature"];
-            std::transform(modelNameStringUpper.begin(), modelNameStringUpper.end(), modelNameStringUpper.begin(), ::toupper);
-            coreTemperatureModelName = magic_enum::enum_cast<OpenMagnetics::CoreTemperatureModels>(modelNameStringUpper).value();
+        else if (path.starts_with("/magnetic/core/functionalDescription/gapping")) {
+            // Gap fringing reaches the winding losses through the proximity effect
+            invalidation.magnetizingInductance = true;
+            invalidation.coreLosses = true;
+            invalidation.windingLosses = true;
+        }
+        else if (path.starts_with(coilPath + "sectionsDescription") || path.starts_with(coilPath + "layersDescription") || path.starts_with(coilPath + "turnsDescription")) {
+            invalidation.windingLosses = true;
+            std::string coilField = path.substr(coilPath.size());
+            invalidation.explicitCoilDescriptions.insert(coilField.substr(0, coilField.find('/')));
+        }
+        else if (path.starts_with(coilPath + "functionalDescription/") && path.find("/numberTurns") != std::string::npos) {
+            // Turns set the inductance and, through the flux density, the core losses, besides the layout of the coil
+            invalidation.magnetizingInductance = true;
+            invalidation.coreLosses = true;
+            invalidation.windingLosses = true;
+            invalidation.coilLayout = true;
+        }
+        else if (path.starts_with(coilPath + "bobbin") || (path.starts_with(coilPath + "functionalDescription/") && (path.find("/wire") != std::string::npos || path.find("/numberParallels") != std::string::npos))) {
+            invalidation.windingLosses = true;
+            invalidation.coilLayout = true;
         }
+        else if (path.starts_with(operatingPointsPath)) {
+            std::string operatingPointPath = path.substr(operatingPointsPath.size());
+            size_t separator = operatingPointPath.find('/');
+            std::string operatingPointIndex = operatingPointPath.substr(0, separator);
+            bool editsInsideOperatingPoint = separator != std::string::npos || operation.at("op") == "replace";
+            if (editsInsideOperatingPoint && !operatingPointIndex.empty() && std::all_of(operatingPointIndex.begin(), operatingPointIndex.end(), ::isdigit)) {
+                invalidation.operatingPoints.insert(std::stoul(operatingPointIndex));
+            }
+            else {
+                // Inserting or removing whole operating points shifts the indexes of the ones after it
+                invalidation.allOperatingPoints = true;
+            }
+        }
+        else {
+            invalidation.invalidate_all();
+        }
+    }
+    return invalidation;
+}
 
-        OpenMagnetics::MagneticSimulator magneticSimulator;
+std::string MKFNet::SimulateDelta(std::string baseKey, std::string patchString, std::string modelsString, std::string resultKey) {
+    MKFNET_SCOPED_TIMER("SimulateDelta");
+    try {
+        std::optional<SimulationRecord> storedBaseRecord;
+        {
+            std::shared_lock<std::shared_mutex> lock(databasesMutex);
+            if (simulationDatabase.contains(baseKey)) {
+                storedBaseRecord = simulationDatabase.at(baseKey);
+            }
+        }
+        if (!storedBaseRecord) {
+            auto storedMas = getStoredMas(baseKey);
+            OpenMagnetics::MagneticWrapper baseMagnetic = storedMas.get_magnetic();
+            OpenMagnetics::InputsWrapper baseInputs = storedMas.get_inputs();
+            SimulationRecord newBaseRecord;
+            to_json(newBaseRecord.document["magnetic"], baseMagnetic);
+            to_json(newBaseRecord.document["inputs"], baseInputs);
+            newBaseRecord.modelsString = modelsString;
+            OpenMagnetics::MagneticSimulator magneticSimulator;
+            configureMagneticSimulator(magneticSimulator, modelsString);
+            newBaseRecord.mas = magneticSimulator.simulate(baseInputs, baseMagnetic);
+            std::unique_lock<std::shared_mutex> lock(databasesMutex);
+            simulationDatabase[baseKey] = newBaseRecord;
+            storedBaseRecord = newBaseRecord;
+        }
+        auto& baseRecord = storedBaseRecord.value();
 
-        magneticSimulator.set_core_losses_model_name(coreLossesModelName);
-        magneticSimulator.set_core_temperature_model_name(coreTemperatureModelName);
-        magneticSimulator.set_reluctance_model_name(reluctanceModelName);
-        auto mas = magneticSimulator.simulate(inputs, magnetic);
+        json patch = parseJson(patchString);
+        auto invalidation = getSimulationInvalidation(patch);
+        if (parseJson(modelsString) != parseJson(baseRecord.modelsString)) {
+            invalidation.invalidate_all();
+        }
+
+        SimulationRecord record;
+        record.document = baseRecord.document.patch(patch);
+        record.modelsString = modelsString;
+
+        // Derived coil levels are dropped so they are wound again, except those the patch itself provides.
+        // A patched level makes the levels below it stale too
+        json magneticJson = record.document["magnetic"];
+        bool staleCoilLevel = invalidation.coilLayout;
+        for (std::string description : {"sectionsDescription", "layersDescription", "turnsDescription"}) {
+            if (invalidation.explicitCoilDescriptions.contains(description)) {
+                staleCoilLevel = true;
+            }
+            else if (staleCoilLevel) {
+                magneticJson["coil"].erase(description);
+            }
+        }
+        OpenMagnetics::MagneticWrapper magnetic(magneticJson);
+        if (invalidation.coilLayout || !invalidation.explicitCoilDescriptions.empty()) {
+            magnetic = expandMagnetic(magnetic);
+        }
+        OpenMagnetics::InputsWrapper inputs(record.document["inputs"]);
+        to_json(record.document["magnetic"], magnetic);
+
+        OpenMagnetics::MagneticSimulator magneticSimulator;
+        configureMagneticSimulator(magneticSimulator, modelsString);
+        auto baseOutputs = baseRecord.mas.get_outputs();
+        std::vector<OpenMagnetics::Outputs> outputs;
+        std::set<std::string> recomputed;
+        for (size_t operatingPointIndex = 0; operatingPointIndex < inputs.get_operating_points().size(); operatingPointIndex++) {
+            auto operatingPoint = inputs.get_operating_points()[operatingPointIndex];
+            bool wholeOperatingPoint = invalidation.allOperatingPoints || invalidation.operatingPoints.contains(operatingPointIndex) || operatingPointIndex >= baseOutputs.size();
+            OpenMagnetics::Outputs operatingPointOutputs = operatingPointIndex < baseOutputs.size()? baseOutputs[operatingPointIndex] : OpenMagnetics::Outputs();
+            if (wholeOperatingPoint || invalidation.magnetizingInductance || !operatingPointOutputs.get_magnetizing_inductance()) {
+                MKFNET_SCOPED_TIMER("magnetizingInductance");
+                operatingPointOutputs.set_magnetizing_inductance(magneticSimulator.calculate_magnetizing_inductance(operatingPoint, magnetic));
+                recomputed.insert("magnetizingInductance");
+            }
+            if (wholeOperatingPoint || invalidation.coreLosses || !operatingPointOutputs.get_core_losses()) {
+                MKFNET_SCOPED_TIMER("coreLosses");
+                operatingPointOutputs.set_core_losses(magneticSimulator.calculate_core_losses(operatingPoint, magnetic));
+                recomputed.insert("coreLosses");
+            }
+            if (wholeOperatingPoint || invalidation.windingLosses || !operatingPointOutputs.get_winding_losses()) {
+                MKFNET_SCOPED_TIMER("windingLosses");
+                operatingPointOutputs.set_winding_losses(magneticSimulator.calculate_winding_losses(operatingPoint, magnetic, operatingPoint.get_conditions().get_ambient_temperature()));
+                recomputed.insert("windingLosses");
+            }
+            outputs.push_back(operatingPointOutputs);
+        }
+        record.mas.set_magnetic(magnetic);
+        record.mas.set_inputs(inputs);
+        record.mas.set_outputs(outputs);
 
         json result;
-        to_json(result, mas);
+        to_json(result, record.mas);
+        result["recomputed"] = recomputed;
+        if (resultKey != "") {
+            MKFNetInternal::StoredMas storedMas(record.mas);
+            std::unique_lock<std::shared_mutex> lock(databasesMutex);
+            masDatabase.insert_or_assign(resultKey, std::move(storedMas));
+            invalidateDerivedData(resultKey);
+            simulationDatabase[resultKey] = std::move(record);
+        }
+        return dumpJson(result);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
 
-        return result.dump(4);
+std::string MKFNet::CalculateOptimizedMagnetics(std::string inputsString, std::string optimizerSettingsString, std::string modelsString, int numberThreads) {
+    MKFNET_SCOPED_TIMER("CalculateOptimizedMagnetics");
+    try {
+        OpenMagnetics::InputsWrapper inputs(parseJson(inputsString));
+        OpenMagnetics::MagneticSimulator magneticSimulator;
+        configureMagneticSimulator(magneticSimulator, modelsString);
+
+        MKFNetInternal::MagneticOptimizer optimizer(inputs, magneticSimulator, parseJson(optimizerSettingsString));
+        auto paretoFront = optimizer.optimize(std::max(0, numberThreads));
+
+        json results = json::array();
+        for (auto& individual : paretoFront) {
+            json result;
+            result["shape"] = optimizer.get_shape_name(individual.genome);
+            result["material"] = optimizer.get_material_name(individual.genome);
+            result["gapLength"] = optimizer.get_gap_length(individual.genome);
+            result["numberTurns"] = individual.genome.numberTurns;
+            result["wire"] = optimizer.get_wire_name(individual.genome);
+            result["losses"] = individual.evaluation->objectives[size_t(MKFNetInternal::OptimizerObjective::LOSSES)];
+            result["volume"] = individual.evaluation->objectives[size_t(MKFNetInternal::OptimizerObjective::VOLUME)];
+            result["temperature"] = individual.evaluation->objectives[size_t(MKFNetInternal::OptimizerObjective::TEMPERATURE)];
+            result["cost"] = individual.evaluation->objectives[size_t(MKFNetInternal::OptimizerObjective::COST)];
+            to_json(result["mas"], individual.evaluation->mas.value());
+            results.push_back(result);
+        }
+        json output;
+        output["numberEvaluations"] = optimizer.get_number_evaluations();
+        output["paretoFront"] = results;
+        return dumpJson(output);
     }
     catch (const std::exception &exc) {
         return "Exception: " + std::string{exc.what()};
@@ -1706,35 +3838,38 @@ std::string MKFNet::Simulate(std::string inputsString, std::string magneticStrin
 
 
 std::string MKFNet::CalculateProcessed(std::string harmonicsString, std::string waveformString) {
+    MKFNET_SCOPED_TIMER("CalculateProcessed");
     OpenMagnetics::Waveform waveform;
     OpenMagnetics::Harmonics harmonics;
-    OpenMagnetics::from_json(json::parse(waveformString), waveform);
-    OpenMagnetics::from_json(json::parse(harmonicsString), harmonics);
+    OpenMagnetics::from_json(parseJson(waveformString), waveform);
+    OpenMagnetics::from_json(parseJson(harmonicsString), harmonics);
 
     auto processed = OpenMagnetics::InputsWrapper::calculate_processed_data(harmonics, waveform, true);
 
     json result;
     to_json(result, processed);
-    return result.dump(4);
+    return dumpJson(result);
 }
 
 
 std::string MKFNet::CalculateHarmonics(std::string waveformString, double frequency) {
+    MKFNET_SCOPED_TIMER("CalculateHarmonics");
     OpenMagnetics::Waveform waveform;
-    OpenMagnetics::from_json(json::parse(waveformString), waveform);
+    OpenMagnetics::from_json(parseJson(waveformString), waveform);
 
     auto sampledCurrentWaveform = OpenMagnetics::InputsWrapper::calculate_sampled_waveform(waveform, frequency);
     auto harmonics = OpenMagnetics::InputsWrapper::calculate_harmonics_data(sampledCurrentWaveform, frequency);
 
     json result;
     to_json(result, harmonics);
-    return result.dump(4);
+    return dumpJson(result);
 }
 
 
 double MKFNet::CalculateSaturationCurrent(std::string magneticString, double temperature) {
+    MKFNET_SCOPED_TIMER("CalculateSaturationCurrent");
     try {
-        OpenMagnetics::MagneticWrapper magnetic(json::parse(magneticString));
+        OpenMagnetics::MagneticWrapper magnetic(parseJson(magneticString));
         return magnetic.calculate_saturation_current(temperature);
     }
     catch (const std::exception &exc) {
@@ -1744,8 +3879,9 @@ double MKFNet::CalculateSaturationCurrent(std::string magneticString, double tem
 }
 
 double MKFNet::CalculateTemperatureFromCoreThermalResistance(std::string coreDataString, double totalLosses) {
+    MKFNET_SCOPED_TIMER("CalculateTemperatureFromCoreThermalResistance");
     try {
-        OpenMagnetics::CoreWrapper core(json::parse(coreDataString), false, false, false);
+        OpenMagnetics::CoreWrapper core(parseJson(coreDataString), false, false, false);
         return OpenMagnetics::Temperature::calculate_temperature_from_core_thermal_resistance(core, totalLosses);
     }
     catch (const std::exception &exc) {
@@ -1753,3 +3889,461 @@ double MKFNet::CalculateTemperatureFromCoreThermalResistance(std::string coreDat
         return -1;
     }
 }
+
+std::string MKFNet::CalculateSteadyStateTemperature(std::string magneticString, std::string inputsString, std::string modelsString, double temperatureTolerance, int maximumNumberIterations, double initialTemperature) {
+    MKFNET_SCOPED_TIMER("CalculateSteadyStateTemperature");
+    try {
+        OpenMagnetics::MagneticWrapper magnetic;
+        OpenMagnetics::InputsWrapper inputs;
+        OpenMagnetics::OperatingPoint operatingPoint;
+        // Only stored magnetics keep their last steady state, inline ones would fill the database with every variant
+        std::optional<std::pair<std::string, std::string>> sweepKey;
+        if (magneticString.starts_with("{")) {
+            magnetic = OpenMagnetics::MagneticWrapper(parseJson(magneticString));
+        }
+        else {
+            magnetic = getStoredMas(magneticString).get_magnetic();
+            sweepKey = std::make_pair(magneticString, modelsString);
+        }
+        // Only a stored magnetic at one of its stored operating points is a problem known to have been solved before
+        std::optional<std::tuple<std::string, size_t, std::string>> warmStartKey;
+        if (inputsString.starts_with("{")) {
+            inputs = OpenMagnetics::InputsWrapper(parseJson(inputsString));
+            operatingPoint = inputs.get_operating_point(0);
+        }
+        else {
+            size_t operatingPointIndex = stoi(inputsString);
+            inputs = getStoredMas(magneticString).get_inputs();
+            operatingPoint = inputs.get_operating_points()[operatingPointIndex];
+            warmStartKey = std::make_tuple(magneticString, operatingPointIndex, modelsString);
+        }
+
+        auto material = magnetic.get_core().get_functional_description().get_material();
+        if (std::holds_alternative<std::string>(material)) {
+            auto resolvedMaterial = MKFNetInternal::CoreMaterialCache::get_instance().get_material(std::get<std::string>(material));
+            magnetic.get_mutable_core().get_mutable_functional_description().set_material(*resolvedMaterial);
+        }
+
+        OpenMagnetics::OperatingPointExcitation excitation = operatingPoint.get_excitations_per_winding()[0];
+        if (!excitation.get_current()) {
+            double magnetizingInductance = OpenMagnetics::resolve_dimensional_values(inputs.get_design_requirements().get_magnetizing_inductance());
+            auto magnetizingCurrent = OpenMagnetics::InputsWrapper::calculate_magnetizing_current(excitation, magnetizingInductance, true, 0.0);
+            excitation.set_current(magnetizingCurrent);
+            operatingPoint.get_mutable_excitations_per_winding()[0] = excitation;
+        }
+
+        OpenMagnetics::MagneticSimulator magneticSimulator;
+        configureMagneticSimulator(magneticSimulator, modelsString);
+        OpenMagnetics::WindingLosses windingLossesModel;
+        OpenMagnetics::CoreWrapper core = magnetic.get_core();
+
+        double ambientTemperature = operatingPoint.get_conditions().get_ambient_temperature();
+        double temperature = ambientTemperature;
+        if (initialTemperature > -273.15) {
+            temperature = initialTemperature;
+        }
+        else if (sweepKey) {
+            // The stored temperature is the fixed point of this same problem, so starting there cannot lead elsewhere.
+            // Otherwise the rise found at the previous operating point is usually close, as sweeps move in small steps
+            std::shared_lock<std::shared_mutex> lock(databasesMutex);
+            auto temperatureIterator = warmStartKey? steadyStateTemperatureDatabase.find(warmStartKey.value()) : steadyStateTemperatureDatabase.end();
+            auto temperatureRiseIterator = steadyStateTemperatureRiseDatabase.find(sweepKey.value());
+            if (temperatureIterator != steadyStateTemperatureDatabase.end()) {
+                temperature = temperatureIterator->second;
+            }
+            else if (temperatureRiseIterator != steadyStateTemperatureRiseDatabase.end()) {
+                temperature = ambientTemperature + temperatureRiseIterator->second;
+            }
+        }
+        double startingTemperature = temperature;
+
+        // Fixed point on the core temperature: losses at the current estimate give the next estimate through the core thermal resistance.
+        // The step is halved whenever the update grows, which damps the oscillation of strongly temperature dependent materials
+        auto lossesOperatingPoint = operatingPoint;
+        OpenMagnetics::CoreLossesOutput coreLossesOutput;
+        OpenMagnetics::WindingLossesOutput windingLossesOutput;
+        double relaxation = 1;
+        double previousUpdate = std::numeric_limits<double>::infinity();
+        bool converged = false;
+        int iteration = 0;
+        while (iteration < std::max(1, maximumNumberIterations)) {
+            iteration++;
+            lossesOperatingPoint.get_mutable_conditions().set_ambient_temperature(temperature);
+            MKFNET_NAMED_TIMER(coreLossesTimer, "coreLosses");
+            coreLossesOutput = magneticSimulator.calculate_core_losses(lossesOperatingPoint, magnetic);
+            coreLossesTimer.stop();
+            MKFNET_NAMED_TIMER(windingLossesTimer, "windingLosses");
+            windingLossesOutput = windingLossesModel.calculate_losses(magnetic, operatingPoint, temperature);
+            windingLossesTimer.stop();
+            double totalLosses = coreLossesOutput.get_core_losses() + windingLossesOutput.get_winding_losses();
+            double temperatureRise = OpenMagnetics::Temperature::calculate_temperature_from_core_thermal_resistance(core, totalLosses);
+
+            double update = ambientTemperature + temperatureRise - temperature;
+            if (std::abs(update) < temperatureTolerance) {
+                temperature += update;
+                converged = true;
+                break;
+            }
+            if (std::abs(update) > std::abs(previousUpdate)) {
+                relaxation /= 2;
+            }
+            previousUpdate = update;
+            temperature += relaxation * update;
+        }
+        if (converged && sweepKey) {
+            std::unique_lock<std::shared_mutex> lock(databasesMutex);
+            if (warmStartKey) {
+                steadyStateTemperatureDatabase[warmStartKey.value()] = temperature;
+            }
+            steadyStateTemperatureRiseDatabase[sweepKey.value()] = temperature - ambientTemperature;
+        }
+
+        json result;
+        result["converged"] = converged;
+        result["numberIterations"] = iteration;
+        result["startingTemperature"] = startingTemperature;
+        result["temperature"] = temperature;
+        result["temperatureRise"] = temperature - ambientTemperature;
+        result["coreLosses"] = coreLossesOutput.get_core_losses();
+        result["windingLosses"] = windingLossesOutput.get_winding_losses();
+        result["totalLosses"] = coreLossesOutput.get_core_losses() + windingLossesOutput.get_winding_losses();
+        to_json(result["coreLossesOutput"], coreLossesOutput);
+        to_json(result["windingLossesOutput"], windingLossesOutput);
+        return dumpJson(result);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+// Strings up to this length live inside the std::string itself in the usual standard libraries
+constexpr size_t smallStringCapacity = 15;
+
+size_t getStringHeapBytes(const std::string& text) {
+    return text.size() > smallStringCapacity? text.size() + 1 : 0;
+}
+
+// Bytes a value takes inside the object or vector holding it, for a MAS object whose JSON is value:
+// numbers, booleans and enums inline, strings and vectors as their headers, nested objects as their members
+size_t getInlineBytes(const json& value) {
+    if (value.is_object()) {
+        size_t bytes = 0;
+        for (auto& member : value) {
+            // Most members of MAS objects are optional, each with its engaged flag padded to 8 bytes
+            bytes += getInlineBytes(member) + sizeof(double);
+        }
+        return bytes;
+    }
+    if (value.is_array()) {
+        return sizeof(std::vector<double>);
+    }
+    if (value.is_string()) {
+        return sizeof(std::string);
+    }
+    return value.is_null()? 0 : sizeof(double);
+}
+
+// Heap memory owned by a MAS object whose JSON is value, the vector buffers and long strings below it
+size_t getHeapBytes(const json& value) {
+    if (value.is_string()) {
+        return getStringHeapBytes(value.get_ref<const std::string&>());
+    }
+    size_t bytes = 0;
+    if (value.is_array()) {
+        for (auto& element : value) {
+            bytes += getInlineBytes(element) + getHeapBytes(element);
+        }
+    }
+    else if (value.is_object()) {
+        for (auto& member : value) {
+            bytes += getHeapBytes(member);
+        }
+    }
+    return bytes;
+}
+
+// Estimated memory of a stored MAS object: its size plus the vectors and strings it owns, found through its JSON
+// as the generated classes hold no other heap data
+template<typename T>
+size_t getObjectBytes(const T& value) {
+    json valueJson;
+    to_json(valueJson, value);
+    return sizeof(T) + getHeapBytes(valueJson);
+}
+
+// Heap memory of a JSON document held as such: a map node per object member, a vector of values per array and
+// a separately allocated std::string per string
+size_t getJsonDocumentHeapBytes(const json& value) {
+    // Red-black tree node header of libstdc++ and the usual allocators
+    const size_t mapNodeBytes = 32;
+    size_t bytes = 0;
+    if (value.is_object()) {
+        bytes += sizeof(json::object_t);
+        for (auto& [key, member] : value.get_ref<const json::object_t&>()) {
+            bytes += mapNodeBytes + sizeof(std::string) + sizeof(json) + getStringHeapBytes(key) + getJsonDocumentHeapBytes(member);
+        }
+    }
+    else if (value.is_array()) {
+        auto& elements = value.get_ref<const json::array_t&>();
+        bytes += sizeof(json::array_t) + elements.capacity() * sizeof(json);
+        for (auto& element : elements) {
+            bytes += getJsonDocumentHeapBytes(element);
+        }
+    }
+    else if (value.is_string()) {
+        bytes += sizeof(std::string) + getStringHeapBytes(value.get_ref<const std::string&>());
+    }
+    return bytes;
+}
+
+std::string MKFNet::GetMemoryUsage() {
+    MKFNET_SCOPED_TIMER("GetMemoryUsage");
+    try {
+        // Every category reports the estimated bytes it holds in memory, shared objects counted once however
+        // many references they have
+        json result;
+        auto addCategory = [&result](const std::string& name, size_t count, size_t references, size_t bytes) {
+            result["categories"][name]["count"] = count;
+            result["categories"][name]["references"] = references;
+            result["categories"][name]["bytes"] = bytes;
+        };
+
+        // Entries are copied out, shared parts by reference, and measured after the lock is released, so that
+        // loading and evaluating designs are not held off while they are walked; keys are measured in place
+        std::vector<std::pair<std::string, MKFNetInternal::StoredMas>> storedMasses;
+        std::vector<std::pair<std::string, SimulationRecord>> simulationRecords;
+        std::vector<std::shared_ptr<const MKFNetInternal::TurnTable>> turnTables;
+        std::vector<OpenMagnetics::SignalDescriptor> magnetizingCurrents;
+        std::vector<OpenMagnetics::CoreWrapper> cores;
+        std::vector<std::shared_ptr<StoredCoilHandle>> storedCoilHandles;
+        size_t turnTableBytes = 0, magnetizingCurrentBytes = 0, coreBytes = 0, coilBytes = 0, steadyStateTemperatureBytes = 0;
+        size_t numberSteadyStateTemperatures = 0;
+        {
+            std::shared_lock<std::shared_mutex> lock(databasesMutex);
+            storedMasses.assign(masDatabase.begin(), masDatabase.end());
+            simulationRecords.assign(simulationDatabase.begin(), simulationDatabase.end());
+            for (auto& [key, turnTable] : turnTableDatabase) {
+                turnTables.push_back(turnTable);
+                turnTableBytes += sizeof(key) + getStringHeapBytes(key);
+            }
+            for (auto& [key, magnetizingCurrent] : magnetizingCurrentDatabase) {
+                magnetizingCurrents.push_back(magnetizingCurrent);
+                magnetizingCurrentBytes += sizeof(key) + getStringHeapBytes(std::get<0>(key)) + std::get<2>(key).capacity() * sizeof(double);
+            }
+            for (auto& [key, core] : coreDatabase) {
+                cores.push_back(core);
+                coreBytes += sizeof(key) + getStringHeapBytes(key);
+            }
+            for (auto& [key, storedCoilHandle] : coilDatabase) {
+                storedCoilHandles.push_back(storedCoilHandle);
+                coilBytes += sizeof(key) + getStringHeapBytes(key);
+            }
+            for (auto& [key, temperature] : steadyStateTemperatureDatabase) {
+                steadyStateTemperatureBytes += sizeof(key) + sizeof(temperature) + getStringHeapBytes(std::get<0>(key)) + getStringHeapBytes(std::get<2>(key));
+            }
+            for (auto& [key, temperatureRise] : steadyStateTemperatureRiseDatabase) {
+                steadyStateTemperatureBytes += sizeof(key) + sizeof(temperatureRise) + getStringHeapBytes(key.first) + getStringHeapBytes(key.second);
+            }
+            numberSteadyStateTemperatures = steadyStateTemperatureDatabase.size() + steadyStateTemperatureRiseDatabase.size();
+        }
+
+        size_t magneticBytes = 0;
+        std::set<const void*> inputs, coreMaterials, coreShapes, wires, outputs;
+        size_t inputsBytes = 0, coreMaterialBytes = 0, coreShapeBytes = 0, wireBytes = 0, outputsBytes = 0;
+        size_t coreMaterialReferences = 0, coreShapeReferences = 0, wireReferences = 0, outputsReferences = 0;
+        for (auto& [key, storedMas] : storedMasses) {
+            magneticBytes += sizeof(key) + getStringHeapBytes(key) + sizeof(storedMas) + getObjectBytes(storedMas.get_stored_magnetic()) + storedMas.get_wires().capacity() * sizeof(std::shared_ptr<const OpenMagnetics::Wire>);
+            if (inputs.insert(storedMas.get_shared_inputs().get()).second) {
+                inputsBytes += getObjectBytes(*storedMas.get_shared_inputs());
+            }
+            if (storedMas.get_core_material()) {
+                coreMaterialReferences++;
+                if (coreMaterials.insert(storedMas.get_core_material().get()).second) {
+                    coreMaterialBytes += getObjectBytes(*storedMas.get_core_material());
+                }
+            }
+            if (storedMas.get_core_shape()) {
+                coreShapeReferences++;
+                if (coreShapes.insert(storedMas.get_core_shape().get()).second) {
+                    coreShapeBytes += getObjectBytes(*storedMas.get_core_shape());
+                }
+            }
+            for (auto& wire : storedMas.get_wires()) {
+                if (wire) {
+                    wireReferences++;
+                    if (wires.insert(wire.get()).second) {
+                        wireBytes += getObjectBytes(*wire);
+                    }
+                }
+            }
+            if (storedMas.get_outputs()) {
+                outputsReferences++;
+                if (outputs.insert(storedMas.get_outputs().get()).second) {
+                    outputsBytes += sizeof(std::vector<OpenMagnetics::Outputs>) + storedMas.get_outputs()->capacity() * sizeof(OpenMagnetics::Outputs) - storedMas.get_outputs()->size() * sizeof(OpenMagnetics::Outputs);
+                    for (auto& operatingPointOutputs : *storedMas.get_outputs()) {
+                        outputsBytes += getObjectBytes(operatingPointOutputs);
+                    }
+                }
+            }
+        }
+        addCategory("magnetics", storedMasses.size(), storedMasses.size(), magneticBytes);
+        addCategory("inputs", inputs.size(), storedMasses.size(), inputsBytes);
+        addCategory("coreMaterials", coreMaterials.size(), coreMaterialReferences, coreMaterialBytes);
+        addCategory("coreShapes", coreShapes.size(), coreShapeReferences, coreShapeBytes);
+        addCategory("wires", wires.size(), wireReferences, wireBytes);
+        addCategory("outputs", outputs.size(), outputsReferences, outputsBytes);
+
+        size_t simulationBytes = 0;
+        for (auto& [key, record] : simulationRecords) {
+            simulationBytes += sizeof(key) + getStringHeapBytes(key) + sizeof(record) + getJsonDocumentHeapBytes(record.document) +
+                               getObjectBytes(record.mas) - sizeof(record.mas) + getStringHeapBytes(record.modelsString);
+        }
+        addCategory("simulations", simulationRecords.size(), simulationRecords.size(), simulationBytes);
+
+        for (auto& turnTable : turnTables) {
+            turnTableBytes += turnTable->get_memory_usage();
+        }
+        addCategory("turnTables", turnTables.size(), turnTables.size(), turnTableBytes);
+
+        for (auto& magnetizingCurrent : magnetizingCurrents) {
+            magnetizingCurrentBytes += getObjectBytes(magnetizingCurrent);
+        }
+        addCategory("magnetizingCurrents", magnetizingCurrents.size(), magnetizingCurrents.size(), magnetizingCurrentBytes);
+
+        for (auto& core : cores) {
+            coreBytes += getObjectBytes(core);
+        }
+        addCategory("coreHandles", cores.size(), cores.size(), coreBytes);
+
+        for (auto& storedCoilHandle : storedCoilHandles) {
+            std::lock_guard<std::mutex> coilHandleLock(storedCoilHandle->mutex);
+            coilBytes += sizeof(StoredCoilHandle) + getObjectBytes(storedCoilHandle->coilHandle.coil) - sizeof(storedCoilHandle->coilHandle.coil);
+        }
+        addCategory("coilHandles", storedCoilHandles.size(), storedCoilHandles.size(), coilBytes);
+
+        addCategory("steadyStateTemperatures", numberSteadyStateTemperatures, numberSteadyStateTemperatures, steadyStateTemperatureBytes);
+
+        auto& coreMaterialCache = MKFNetInternal::CoreMaterialCache::get_instance();
+        size_t cachedCoreMaterialBytes = 0;
+        auto cachedCoreMaterials = coreMaterialCache.get_materials();
+        for (auto& coreMaterial : cachedCoreMaterials) {
+            cachedCoreMaterialBytes += getObjectBytes(*coreMaterial);
+        }
+        addCategory("cachedCoreMaterials", cachedCoreMaterials.size(), cachedCoreMaterials.size(), cachedCoreMaterialBytes);
+        auto coreMaterialCacheUsage = coreMaterialCache.get_memory_usage();
+        addCategory("coreMaterialSurfaces", coreMaterialCacheUsage.numberSurfaces, coreMaterialCacheUsage.numberSurfaces, coreMaterialCacheUsage.surfaceBytes);
+
+        auto& skinEffectTableCache = MKFNetInternal::SkinEffectTableCache::get_instance();
+        addCategory("skinEffectTables", skinEffectTableCache.size(), skinEffectTableCache.size(), skinEffectTableCache.get_memory_usage());
+
+        // Only a job system already started is looked at, so asking for the memory usage never starts one
+        std::shared_ptr<MKFNetInternal::JobSystem> currentJobSystem;
+        {
+            std::lock_guard<std::mutex> jobSystemLock(jobSystemMutex);
+            currentJobSystem = jobSystem;
+        }
+        auto [numberRetainedJobs, retainedResultBytes] = currentJobSystem? currentJobSystem->get_retained_results() : std::pair<size_t, size_t>{0, 0};
+        addCategory("jobResults", numberRetainedJobs, numberRetainedJobs, retainedResultBytes);
+
+        size_t totalBytes = 0;
+        for (auto& [name, category] : result["categories"].items()) {
+            totalBytes += category["bytes"].get<size_t>();
+        }
+        result["totalBytes"] = totalBytes;
+        return result.dump(4);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+// Upper bound of the histogram bucket holding the given quantile, capped by the largest duration seen
+double estimateStageQuantileMilliseconds(const std::vector<uint64_t>& buckets, uint64_t count, uint64_t maximumNanoseconds, double quantile) {
+    uint64_t accumulatedCount = 0;
+    for (size_t bucketIndex = 0; bucketIndex < buckets.size(); bucketIndex++) {
+        accumulatedCount += buckets[bucketIndex];
+        if (accumulatedCount >= quantile * count) {
+            return std::min(std::ldexp(1e-3, int(bucketIndex)), maximumNanoseconds * 1e-6);
+        }
+    }
+    return maximumNanoseconds * 1e-6;
+}
+
+std::string MKFNet::GetMetrics(bool reset) {
+    try {
+        json result;
+#ifdef MKFNET_DISABLE_METRICS
+        result["enabled"] = false;
+#else
+        result["enabled"] = true;
+#endif
+        result["stages"] = json::object();
+        for (auto stage : MKFNetInternal::Metrics::get_instance().get_stages()) {
+            auto count = stage->get_count();
+            if (count == 0) {
+                continue;
+            }
+            auto buckets = stage->get_buckets();
+            auto maximumNanoseconds = stage->get_maximum_nanoseconds();
+            json stageJson;
+            stageJson["count"] = count;
+            stageJson["totalMilliseconds"] = stage->get_total_nanoseconds() * 1e-6;
+            stageJson["meanMilliseconds"] = stage->get_total_nanoseconds() * 1e-6 / count;
+            stageJson["maximumMilliseconds"] = maximumNanoseconds * 1e-6;
+            stageJson["p50Milliseconds"] = estimateStageQuantileMilliseconds(buckets, count, maximumNanoseconds, 0.5);
+            stageJson["p90Milliseconds"] = estimateStageQuantileMilliseconds(buckets, count, maximumNanoseconds, 0.9);
+            stageJson["p99Milliseconds"] = estimateStageQuantileMilliseconds(buckets, count, maximumNanoseconds, 0.99);
+            auto lastUsedBucket = std::find_if(buckets.rbegin(), buckets.rend(), [](uint64_t bucketCount) { return bucketCount > 0; });
+            buckets.erase(lastUsedBucket.base(), buckets.end());
+            stageJson["histogram"]["counts"] = buckets;
+            stageJson["histogram"]["upperBoundsMicroseconds"] = json::array();
+            for (size_t bucketIndex = 0; bucketIndex < buckets.size(); bucketIndex++) {
+                stageJson["histogram"]["upperBoundsMicroseconds"].push_back(uint64_t(1) << bucketIndex);
+            }
+            result["stages"][stage->get_name()] = stageJson;
+        }
+        if (reset) {
+            MKFNetInternal::Metrics::get_instance().reset();
+        }
+        return result.dump(4);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+void MKFNet::ResetMetrics() {
+    MKFNetInternal::Metrics::get_instance().reset();
+}
+
+void MKFNet::SetCallTracing(bool enabled) {
+    MKFNetInternal::Metrics::get_instance().set_call_tracing(enabled);
+}
+
+std::string MKFNet::GetLastCallTrace() {
+    try {
+        auto traceEvents = MKFNetInternal::Metrics::get_instance().get_last_call_trace();
+        if (!traceEvents) {
+            throw std::runtime_error("No call has been traced, enable it with SetCallTracing first");
+        }
+        // Chrome trace event format, complete events with microsecond timestamps, loadable in chrome://tracing or Perfetto
+        json result;
+        result["displayTimeUnit"] = "ms";
+        result["traceEvents"] = json::array();
+        for (auto& traceEvent : traceEvents.value()) {
+            json eventJson;
+            eventJson["name"] = traceEvent.name;
+            eventJson["cat"] = "MKFNet";
+            eventJson["ph"] = "X";
+            eventJson["ts"] = traceEvent.startNanoseconds * 1e-3;
+            eventJson["dur"] = traceEvent.durationNanoseconds * 1e-3;
+            eventJson["pid"] = 0;
+            eventJson["tid"] = traceEvent.threadIndex;
+            result["traceEvents"].push_back(eventJson);
+        }
+        return result.dump(4);
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
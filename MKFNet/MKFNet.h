@@ -1,3 +1,10 @@
+// Receives the end of every asynchronous job; implemented on the managed side through a SWIG director
+class MKFNetJobCallback {
+public:
+    virtual ~MKFNetJobCallback() {}
+    virtual void OnJobFinished(int jobId, std::string status, std::string result) {}
+};
+
 class MKFNet {
     std::string name;
 public:
@@ -10,6 +17,8 @@ public:
     std::string LoadMagneticsFromFile(std::string path, std::string inputsString, bool expand);
     std::string ReadMas(std::string key);
     std::string ReadDatabases(std::string path, bool addInternalData);
+    std::string WriteCatalogSnapshot(std::string path, std::string snapshotPath);
+    std::string ReadCatalogSnapshot(std::string snapshotPath, bool addInternalData);
 
     std::string FindCoreMaterialByName(std::string materialName);
     std::string FindCoreShapeByName(std::string shapeName);
@@ -32,25 +41,40 @@ public:
     std::string GetInsulationMaterials();
     std::string GetWireMaterials();
 
+    std::string LoadCore(std::string key, std::string coreDataString, bool includeMaterialData);
+    bool UnloadCore(std::string key);
     std::string CalculateCoreData(std::string coreDataString, bool includeMaterialData);
     std::string Wind(std::string coilString, size_t repetitions = 1, std::string proportionPerWindingString = "[]", std::string patternString = "[]");
     std::string WindBySections(std::string coilString, size_t repetitions = 1, std::string proportionPerWindingString = "[]", std::string patternString = "[]");
     std::string WindByLayers(std::string coilString);
     std::string WindByTurns(std::string coilString);
     std::string DelimitAndCompact(std::string coilString);
+    std::string LoadCoil(std::string key, std::string coilString);
+    bool UnloadCoil(std::string key);
+    std::string UpdateCoil(std::string key, std::string coilChangesString);
+    std::string ReadCoil(std::string key);
 
     std::string GetDefaultModels(); 
     std::string CalculateCoreLosses(std::string magneticString, std::string inputsData, std::string modelsData);
+    double CalculateCoreLossesDensity(std::string materialName, std::string modelName, double magneticFluxDensityPeak, double frequency, double temperature);
+    std::string CalculateCoreLossesDensityMap(std::string materialNamesString, std::string magneticFluxDensityPeaksString, std::string frequenciesString, std::string temperaturesString, std::string waveformShapesString, std::string modelName, int numberThreads = 0);
+    double CalculateInitialPermeability(std::string materialName, double magneticFieldDcBias, double temperature);
+    std::string PrecomputeCoreMaterials(std::string materialNamesString, std::string modelNamesString, int numberThreads = 0);
+    void ClearCoreMaterialCache();
     std::string CalculateAdvisedCores(std::string inputsString, std::string weightsString, int maximumNumberResults, bool useOnlyCoresInStock);
     std::string CalculateAdvisedMagnetics(std::string inputsString, int maximumNumberResults);
     std::string CalculateWindingLosses(std::string magneticString, std::string operatingPointString, double temperature, double windingLossesHarmonicAmplitudeThreshold);
+    std::string CalculateWindingPatterns(std::string magneticString, std::string operatingPointString, double temperature, int maximumRepetitions = 2, int numberThreads = 0);
     std::string CalculateCoreProcessedDescription(std::string coreDataString);
     std::string CalculateCoreGeometricalDescription(std::string coreDataString);
     std::string CalculateCoreGapping(std::string coreDataString);
     std::string CalculateOhmicLosses(std::string coilString, std::string operatingPointString, double temperature);
     std::string CalculateSkinEffectLosses(std::string coilString, std::string windingLossesOutputString, double temperature);
     std::string CalculateSkinEffectLossesPerMeter(std::string wireString, std::string currentString, double temperature, double currentDivider = 1);
+    void ClearSkinEffectTables();
+    std::string CalculateAdvisedWires(std::string excitationString, double temperature, std::string constraintsString, int maximumNumberResults = 10, int numberThreads = 0);
     std::string CalculateMagneticFieldStrengthField(std::string operatingPointString, std::string magneticString);
+    std::string CalculateWindingWindowMagneticStrengthField(std::string operatingPointString, std::string magneticString, int numberPointsX = 0, int numberPointsY = 0);
     std::string CalculateProximityEffectLosses(std::string coilString, double temperature, std::string windingLossesOutputString, std::string windingWindowMagneticStrengthFieldOutputString);
 
     std::string CalculateInductanceAndMagneticFluxDensity(std::string coreData, std::string coilData, std::string operatingPointData, std::string modelsData);
@@ -61,6 +85,8 @@ public:
     std::string CalculateEffectiveCurrentDensity(std::string magneticString, std::string operatingPointString, double temperature);
 
     std::string Simulate(std::string inputsString, std::string magneticString, std::string modelsData);
+    std::string SimulateDelta(std::string baseKey, std::string patchString, std::string modelsString, std::string resultKey = "");
+    std::string CalculateOptimizedMagnetics(std::string inputsString, std::string optimizerSettingsString, std::string modelsString, int numberThreads = 0);
     std::string CalculateProcessed(std::string harmonicsString, std::string waveformString);
     std::string CalculateHarmonics(std::string waveformString, double frequency);
 
@@ -76,14 +102,41 @@ public:
     double CalculateRequiredMagneticEnergy(std::string inputsString);
     double CalculateSaturationCurrent(std::string magneticString, double temperature);
     double CalculateTemperatureFromCoreThermalResistance(std::string coreString, double totalLosses);
+    // Iteration starts at initialTemperature; left below absolute zero, it starts at the last steady state found for the
+    // same stored magnetic, shifted to the new ambient temperature, or at ambient when there is none
+    std::string CalculateSteadyStateTemperature(std::string magneticString, std::string inputsString, std::string modelsString, double temperatureTolerance = 0.1, int maximumNumberIterations = 50, double initialTemperature = -300);
 
 
     bool PlotField(std::string magneticString, std::string operatingPointString, std::string outFile);
+    // Draws at most maximumNumberPrimitives conductors, field points and outline shapes, a budget estimated from the
+    // coil views rather than counted in the SVG; returns false when not even the coarsest view fits in it
+    bool PlotFieldPreview(std::string magneticString, std::string operatingPointString, std::string outFile, int maximumNumberPrimitives = 2000);
     bool PlotCore(std::string magneticString, std::string outFile);
     bool PlotSections(std::string magneticString, std::string outFile);
     bool PlotLayers(std::string magneticString, std::string outFile);
     bool PlotTurns(std::string magneticString, std::string outFile);
+    std::string PlotBatch(std::string plotJobsString, int numberThreads = 0);
+    std::string PlotToString(std::string magneticString, std::string plotKind, std::string operatingPointString = "");
+    std::string PlotToCompressedString(std::string magneticString, std::string plotKind, std::string operatingPointString = "");
     std::string GetSettings();
     void SetSettings(std::string settingsString);
     void ResetSettings();
+    // Replaces the job system; false while it still holds jobs, queued, running or not yet released
+    bool StartJobs(int numberWorkers = 0, int queueCapacity = 256);
+    int SubmitSimulate(std::string inputsString, std::string magneticString, std::string modelsData);
+    int SubmitCalculateAdvisedCores(std::string inputsString, std::string weightsString, int maximumNumberResults, bool useOnlyCoresInStock);
+    int SubmitCalculateAdvisedMagnetics(std::string inputsString, int maximumNumberResults);
+    int SubmitPlot(std::string magneticString, std::string plotKind, std::string operatingPointString, std::string outFile);
+    int SubmitPlotToString(std::string magneticString, std::string plotKind, std::string operatingPointString = "");
+    std::string PollJob(int jobId);
+    std::string WaitJob(int jobId, int timeoutMilliseconds = -1);
+    std::string GetJobResult(int jobId);
+    bool CancelJob(int jobId);
+    bool ReleaseJob(int jobId);
+    void SetJobCallback(MKFNetJobCallback* callback);
+    std::string GetMetrics(bool reset = false);
+    void ResetMetrics();
+    void SetCallTracing(bool enabled);
+    std::string GetLastCallTrace();
+    std::string GetMemoryUsage();
 };
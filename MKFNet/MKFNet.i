@@ -1,4 +1,4 @@
-%module MKFNetModule
+%module(directors="1") MKFNetModule
 
 
 %include <std_string.i>
@@ -11,4 +11,6 @@
 %}
 
 
+%feature("director") MKFNetJobCallback;
+
 %include "MKFNet.h"
\ No newline at end of file
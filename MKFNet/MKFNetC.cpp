@@ -0,0 +1,80 @@
+#include "MKFNetC.h"
+#include "MKFNetDispatcher.h"
+#include "MKFNet.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+struct mkfnet_handle {
+    MKFNet mkfNet;
+};
+
+namespace {
+    char* copy_to_c_string(const std::string& value) {
+        auto copy = static_cast<char*>(std::malloc(value.size() + 1));
+        if (copy) {
+            std::memcpy(copy, value.c_str(), value.size() + 1);
+        }
+        return copy;
+    }
+}
+
+extern "C" {
+
+int mkfnet_abi_version(void) {
+    return MKFNET_C_ABI_VERSION;
+}
+
+mkfnet_handle* mkfnet_create(void) {
+    return new (std::nothrow) mkfnet_handle();
+}
+
+void mkfnet_destroy(mkfnet_handle* handle) {
+    delete handle;
+}
+
+char* mkfnet_call(mkfnet_handle* handle, const char* operation, const char* argumentsJson) {
+    try {
+        if (!handle || !operation) {
+            return copy_to_c_string("Exception: mkfnet_call needs a handle and an operation");
+        }
+        return copy_to_c_string(MKFNetInternal::dispatch_call(handle->mkfNet, operation, argumentsJson? argumentsJson : ""));
+    }
+    catch (...) {
+        // Nothing may cross the C boundary, not even an allocation failure while building the message
+        return copy_to_c_string("Exception: Unexpected error in mkfnet_call");
+    }
+}
+
+char* mkfnet_call_strings(mkfnet_handle* handle, const char* operation, const char* const* arguments, size_t numberArguments) {
+    try {
+        if (!handle || !operation || (!arguments && numberArguments > 0)) {
+            return copy_to_c_string("Exception: mkfnet_call_strings needs a handle, an operation and its arguments");
+        }
+        std::vector<const char*> textArguments(arguments, arguments + numberArguments);
+        return copy_to_c_string(MKFNetInternal::dispatch_call(handle->mkfNet, operation, textArguments));
+    }
+    catch (...) {
+        return copy_to_c_string("Exception: Unexpected error in mkfnet_call_strings");
+    }
+}
+
+char* mkfnet_list_operations(void) {
+    try {
+        std::string operationNames = "[";
+        for (auto& operationName : MKFNetInternal::get_operation_names()) {
+            operationNames += (operationNames.size() > 1? ",\"" : "\"") + operationName + "\"";
+        }
+        return copy_to_c_string(operationNames + "]");
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void mkfnet_free_string(char* string) {
+    std::free(string);
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+/* Plain C entry point to every MKFNet call, for native callers that do not go through the C# wrapper.
+   Operations and their arguments are those of MKFNet.h, see MKFNetDispatcher.h for the argument format */
+
+#if defined(_WIN32)
+#if defined(MKFNET_C_BUILDING)
+#define MKFNET_C_API __declspec(dllexport)
+#else
+#define MKFNET_C_API __declspec(dllimport)
+#endif
+#else
+#define MKFNET_C_API __attribute__((visibility("default")))
+#endif
+
+/* Version 2 adds mkfnet_call_strings */
+#define MKFNET_C_ABI_VERSION 2
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mkfnet_handle mkfnet_handle;
+
+MKFNET_C_API int mkfnet_abi_version(void);
+
+/* Databases and stored magnetics are shared by every handle of the process */
+MKFNET_C_API mkfnet_handle* mkfnet_create(void);
+MKFNET_C_API void mkfnet_destroy(mkfnet_handle* handle);
+
+/* Returns the result of the operation, or "Exception: ..." on failure, never NULL unless out of memory.
+   The string is owned by the caller and released with mkfnet_free_string */
+MKFNET_C_API char* mkfnet_call(mkfnet_handle* handle, const char* operation, const char* argumentsJson);
+
+/* Same with one string per parameter of the operation, in the order of MKFNet.h. String parameters receive theirs
+   unchanged, without being wrapped in or parsed as JSON; numbers and booleans are written as JSON text.
+   A NULL entry, or leaving trailing ones out, takes the default value of that parameter */
+MKFNET_C_API char* mkfnet_call_strings(mkfnet_handle* handle, const char* operation, const char* const* arguments, size_t numberArguments);
+
+/* JSON array with the name of every operation mkfnet_call accepts */
+MKFNET_C_API char* mkfnet_list_operations(void);
+
+MKFNET_C_API void mkfnet_free_string(char* string);
+
+#ifdef __cplusplus
+}
+#endif
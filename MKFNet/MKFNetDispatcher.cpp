@@ -0,0 +1,576 @@
+#include "MKFNetDispatcher.h"
+#include "MKFNet.h"
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <json.hpp>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace MKFNetInternal {
+
+namespace {
+    // Arguments as one JSON document, or as positional texts that string parameters take without any parsing
+    class OperationArguments {
+        private:
+            const json* _arguments = nullptr;
+            const std::vector<const char*>* _textArguments = nullptr;
+
+            const json* find(size_t index, const char* name) const {
+                if (_arguments->is_array()) {
+                    return index < _arguments->size()? &(*_arguments)[index] : nullptr;
+                }
+                auto argumentIterator = _arguments->find(name);
+                return argumentIterator != _arguments->end()? &*argumentIterator : nullptr;
+            }
+
+            template<typename T>
+            T get_default(const char* name, std::optional<T> defaultValue) const {
+                if (!defaultValue) {
+                    throw std::invalid_argument("Missing argument " + std::string(name));
+                }
+                return defaultValue.value();
+            }
+
+        public:
+            explicit OperationArguments(const json& arguments) : _arguments(&arguments) {}
+            explicit OperationArguments(const std::vector<const char*>& textArguments) : _textArguments(&textArguments) {}
+
+            template<typename T>
+            T get(size_t index, const char* name, std::optional<T> defaultValue = std::nullopt) const {
+                if (_textArguments) {
+                    if (index >= _textArguments->size() || !(*_textArguments)[index]) {
+                        return get_default(name, defaultValue);
+                    }
+                    if constexpr (std::is_same_v<T, std::string>) {
+                        return std::string((*_textArguments)[index]);
+                    }
+                    else {
+                        return json::parse((*_textArguments)[index]).get<T>();
+                    }
+                }
+                auto argument = find(index, name);
+                if (!argument || argument->is_null()) {
+                    return get_default(name, defaultValue);
+                }
+                if constexpr (std::is_same_v<T, std::string>) {
+                    return argument->is_string()? argument->get<std::string>() : argument->dump();
+                }
+                else {
+                    return argument->get<T>();
+                }
+            }
+    };
+
+    std::string to_result(std::string result) {
+        return result;
+    }
+
+    template<typename T>
+    std::string to_result(T result) {
+        return json(result).dump();
+    }
+
+    using Operation = std::function<std::string(MKFNet&, const OperationArguments&)>;
+
+    const std::map<std::string, Operation>& get_operations() {
+        static const std::map<std::string, Operation> operations = {
+        {"LoadDatabases", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            mkfNet.LoadDatabases(arguments.get<std::string>(0, "databasesString"));
+            return std::string();
+        }},
+        {"LoadMas", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.LoadMas(arguments.get<std::string>(0, "key"), arguments.get<std::string>(1, "masString"), arguments.get<bool>(2, "expand")));
+        }},
+        {"LoadMagnetic", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.LoadMagnetic(arguments.get<std::string>(0, "key"), arguments.get<std::string>(1, "magneticString"), arguments.get<std::string>(2, "inputsString"), arguments.get<bool>(3, "expand")));
+        }},
+        {"LoadMagnetics", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.LoadMagnetics(arguments.get<std::string>(0, "keys"), arguments.get<std::string>(1, "magneticsString"), arguments.get<std::string>(2, "inputsString"), arguments.get<bool>(3, "expand")));
+        }},
+        {"LoadMagneticsFromFile", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.LoadMagneticsFromFile(arguments.get<std::string>(0, "path"), arguments.get<std::string>(1, "inputsString"), arguments.get<bool>(2, "expand")));
+        }},
+        {"ReadMas", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.ReadMas(arguments.get<std::string>(0, "key")));
+        }},
+        {"ReadDatabases", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.ReadDatabases(arguments.get<std::string>(0, "path"), arguments.get<bool>(1, "addInternalData")));
+        }},
+        {"WriteCatalogSnapshot", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.WriteCatalogSnapshot(arguments.get<std::string>(0, "path"), arguments.get<std::string>(1, "snapshotPath")));
+        }},
+        {"ReadCatalogSnapshot", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.ReadCatalogSnapshot(arguments.get<std::string>(0, "snapshotPath"), arguments.get<bool>(1, "addInternalData")));
+        }},
+        {"FindCoreMaterialByName", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.FindCoreMaterialByName(arguments.get<std::string>(0, "materialName")));
+        }},
+        {"FindCoreShapeByName", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.FindCoreShapeByName(arguments.get<std::string>(0, "shapeName")));
+        }},
+        {"FindWireByName", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.FindWireByName(arguments.get<std::string>(0, "wireName")));
+        }},
+        {"FindBobbinByName", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.FindBobbinByName(arguments.get<std::string>(0, "bobbinName")));
+        }},
+        {"FindInsulationMaterialByName", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.FindInsulationMaterialByName(arguments.get<std::string>(0, "insulationMaterialName")));
+        }},
+        {"FindWireMaterialByName", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.FindWireMaterialByName(arguments.get<std::string>(0, "wireMaterialName")));
+        }},
+        {"GetCoreMaterialNames", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetCoreMaterialNames());
+        }},
+        {"GetCoreShapeNames", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetCoreShapeNames());
+        }},
+        {"GetWireNames", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetWireNames());
+        }},
+        {"GetBobbinNames", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetBobbinNames());
+        }},
+        {"GetInsulationMaterialNames", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetInsulationMaterialNames());
+        }},
+        {"GetWireMaterialNames", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetWireMaterialNames());
+        }},
+        {"GetCoreMaterials", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetCoreMaterials());
+        }},
+        {"GetCoreShapes", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetCoreShapes());
+        }},
+        {"GetWires", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetWires());
+        }},
+        {"GetBobbins", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetBobbins());
+        }},
+        {"GetInsulationMaterials", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetInsulationMaterials());
+        }},
+        {"GetWireMaterials", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetWireMaterials());
+        }},
+        {"LoadCore", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.LoadCore(arguments.get<std::string>(0, "key"), arguments.get<std::string>(1, "coreDataString"), arguments.get<bool>(2, "includeMaterialData")));
+        }},
+        {"UnloadCore", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.UnloadCore(arguments.get<std::string>(0, "key")));
+        }},
+        {"CalculateCoreData", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateCoreData(arguments.get<std::string>(0, "coreDataString"), arguments.get<bool>(1, "includeMaterialData")));
+        }},
+        {"Wind", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.Wind(arguments.get<std::string>(0, "coilString"), arguments.get<size_t>(1, "repetitions", size_t(1)), arguments.get<std::string>(2, "proportionPerWindingString", std::string("[]")), arguments.get<std::string>(3, "patternString", std::string("[]"))));
+        }},
+        {"WindBySections", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.WindBySections(arguments.get<std::string>(0, "coilString"), arguments.get<size_t>(1, "repetitions", size_t(1)), arguments.get<std::string>(2, "proportionPerWindingString", std::string("[]")), arguments.get<std::string>(3, "patternString", std::string("[]"))));
+        }},
+        {"WindByLayers", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.WindByLayers(arguments.get<std::string>(0, "coilString")));
+        }},
+        {"WindByTurns", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.WindByTurns(arguments.get<std::string>(0, "coilString")));
+        }},
+        {"DelimitAndCompact", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.DelimitAndCompact(arguments.get<std::string>(0, "coilString")));
+        }},
+        {"LoadCoil", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.LoadCoil(arguments.get<std::string>(0, "key"), arguments.get<std::string>(1, "coilString")));
+        }},
+        {"UnloadCoil", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.UnloadCoil(arguments.get<std::string>(0, "key")));
+        }},
+        {"UpdateCoil", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.UpdateCoil(arguments.get<std::string>(0, "key"), arguments.get<std::string>(1, "coilChangesString")));
+        }},
+        {"ReadCoil", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.ReadCoil(arguments.get<std::string>(0, "key")));
+        }},
+        {"GetDefaultModels", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetDefaultModels());
+        }},
+        {"CalculateCoreLosses", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateCoreLosses(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "inputsData"), arguments.get<std::string>(2, "modelsData")));
+        }},
+        {"CalculateCoreLossesDensity", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateCoreLossesDensity(arguments.get<std::string>(0, "materialName"), arguments.get<std::string>(1, "modelName"), arguments.get<double>(2, "magneticFluxDensityPeak"), arguments.get<double>(3, "frequency"), arguments.get<double>(4, "temperature")));
+        }},
+        {"CalculateCoreLossesDensityMap", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateCoreLossesDensityMap(arguments.get<std::string>(0, "materialNamesString"), arguments.get<std::string>(1, "magneticFluxDensityPeaksString"), arguments.get<std::string>(2, "frequenciesString"), arguments.get<std::string>(3, "temperaturesString"), arguments.get<std::string>(4, "waveformShapesString"), arguments.get<std::string>(5, "modelName"), arguments.get<int>(6, "numberThreads", 0)));
+        }},
+        {"CalculateInitialPermeability", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateInitialPermeability(arguments.get<std::string>(0, "materialName"), arguments.get<double>(1, "magneticFieldDcBias"), arguments.get<double>(2, "temperature")));
+        }},
+        {"PrecomputeCoreMaterials", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.PrecomputeCoreMaterials(arguments.get<std::string>(0, "materialNamesString"), arguments.get<std::string>(1, "modelNamesString"), arguments.get<int>(2, "numberThreads", 0)));
+        }},
+        {"ClearCoreMaterialCache", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            mkfNet.ClearCoreMaterialCache();
+            return std::string();
+        }},
+        {"CalculateAdvisedCores", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateAdvisedCores(arguments.get<std::string>(0, "inputsString"), arguments.get<std::string>(1, "weightsString"), arguments.get<int>(2, "maximumNumberResults"), arguments.get<bool>(3, "useOnlyCoresInStock")));
+        }},
+        {"CalculateAdvisedMagnetics", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateAdvisedMagnetics(arguments.get<std::string>(0, "inputsString"), arguments.get<int>(1, "maximumNumberResults")));
+        }},
+        {"CalculateWindingLosses", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateWindingLosses(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "operatingPointString"), arguments.get<double>(2, "temperature"), arguments.get<double>(3, "windingLossesHarmonicAmplitudeThreshold")));
+        }},
+        {"CalculateWindingPatterns", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateWindingPatterns(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "operatingPointString"), arguments.get<double>(2, "temperature"), arguments.get<int>(3, "maximumRepetitions", 2), arguments.get<int>(4, "numberThreads", 0)));
+        }},
+        {"CalculateCoreProcessedDescription", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateCoreProcessedDescription(arguments.get<std::string>(0, "coreDataString")));
+        }},
+        {"CalculateCoreGeometricalDescription", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateCoreGeometricalDescription(arguments.get<std::string>(0, "coreDataString")));
+        }},
+        {"CalculateCoreGapping", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateCoreGapping(arguments.get<std::string>(0, "coreDataString")));
+        }},
+        {"CalculateOhmicLosses", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateOhmicLosses(arguments.get<std::string>(0, "coilString"), arguments.get<std::string>(1, "operatingPointString"), arguments.get<double>(2, "temperature")));
+        }},
+        {"CalculateSkinEffectLosses", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateSkinEffectLosses(arguments.get<std::string>(0, "coilString"), arguments.get<std::string>(1, "windingLossesOutputString"), arguments.get<double>(2, "temperature")));
+        }},
+        {"CalculateSkinEffectLossesPerMeter", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateSkinEffectLossesPerMeter(arguments.get<std::string>(0, "wireString"), arguments.get<std::string>(1, "currentString"), arguments.get<double>(2, "temperature"), arguments.get<double>(3, "currentDivider", 1)));
+        }},
+        {"ClearSkinEffectTables", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            mkfNet.ClearSkinEffectTables();
+            return std::string();
+        }},
+        {"CalculateAdvisedWires", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateAdvisedWires(arguments.get<std::string>(0, "excitationString"), arguments.get<double>(1, "temperature"), arguments.get<std::string>(2, "constraintsString"), arguments.get<int>(3, "maximumNumberResults", 10), arguments.get<int>(4, "numberThreads", 0)));
+        }},
+        {"CalculateMagneticFieldStrengthField", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateMagneticFieldStrengthField(arguments.get<std::string>(0, "operatingPointString"), arguments.get<std::string>(1, "magneticString")));
+        }},
+        {"CalculateWindingWindowMagneticStrengthField", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateWindingWindowMagneticStrengthField(arguments.get<std::string>(0, "operatingPointString"), arguments.get<std::string>(1, "magneticString"), arguments.get<int>(2, "numberPointsX", 0), arguments.get<int>(3, "numberPointsY", 0)));
+        }},
+        {"CalculateProximityEffectLosses", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateProximityEffectLosses(arguments.get<std::string>(0, "coilString"), arguments.get<double>(1, "temperature"), arguments.get<std::string>(2, "windingLossesOutputString"), arguments.get<std::string>(3, "windingWindowMagneticStrengthFieldOutputString")));
+        }},
+        {"CalculateInductanceAndMagneticFluxDensity", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateInductanceAndMagneticFluxDensity(arguments.get<std::string>(0, "coreData"), arguments.get<std::string>(1, "coilData"), arguments.get<std::string>(2, "operatingPointData"), arguments.get<std::string>(3, "modelsData")));
+        }},
+        {"CalculateInductanceFromNumberTurnsAndGapping", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateInductanceFromNumberTurnsAndGapping(arguments.get<std::string>(0, "coreData"), arguments.get<std::string>(1, "coilData"), arguments.get<std::string>(2, "operatingPointData"), arguments.get<std::string>(3, "modelsData")));
+        }},
+        {"CalculateNumberTurnsFromGappingAndInductance", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateNumberTurnsFromGappingAndInductance(arguments.get<std::string>(0, "coreData"), arguments.get<std::string>(1, "inputsData"), arguments.get<std::string>(2, "modelsData")));
+        }},
+        {"CalculateGappingFromNumberTurnsAndInductance", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateGappingFromNumberTurnsAndInductance(arguments.get<std::string>(0, "coreData"), arguments.get<std::string>(1, "coilData"), arguments.get<std::string>(2, "inputsData"), arguments.get<std::string>(3, "gappingTypeString"), arguments.get<int>(4, "decimals"), arguments.get<std::string>(5, "modelsData")));
+        }},
+        {"CalculateEffectiveCurrentDensity", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateEffectiveCurrentDensity(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "operatingPointString"), arguments.get<double>(2, "temperature")));
+        }},
+        {"Simulate", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.Simulate(arguments.get<std::string>(0, "inputsString"), arguments.get<std::string>(1, "magneticString"), arguments.get<std::string>(2, "modelsData")));
+        }},
+        {"SimulateDelta", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.SimulateDelta(arguments.get<std::string>(0, "baseKey"), arguments.get<std::string>(1, "patchString"), arguments.get<std::string>(2, "modelsString"), arguments.get<std::string>(3, "resultKey", std::string())));
+        }},
+        {"CalculateOptimizedMagnetics", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateOptimizedMagnetics(arguments.get<std::string>(0, "inputsString"), arguments.get<std::string>(1, "optimizerSettingsString"), arguments.get<std::string>(2, "modelsString"), arguments.get<int>(3, "numberThreads", 0)));
+        }},
+        {"CalculateProcessed", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateProcessed(arguments.get<std::string>(0, "harmonicsString"), arguments.get<std::string>(1, "waveformString")));
+        }},
+        {"CalculateHarmonics", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateHarmonics(arguments.get<std::string>(0, "waveformString"), arguments.get<double>(1, "frequency")));
+        }},
+        {"GetOuterDiameterEnameledRound", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetOuterDiameterEnameledRound(arguments.get<double>(0, "conductingDiameter"), arguments.get<int>(1, "grade", 1), arguments.get<std::string>(2, "standardString", std::string("IEC_60317"))));
+        }},
+        {"GetOuterDiameterInsulatedRound", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetOuterDiameterInsulatedRound(arguments.get<double>(0, "conductingDiameter"), arguments.get<int>(1, "numberLayers"), arguments.get<double>(2, "thicknessLayers"), arguments.get<std::string>(3, "standardString", std::string("IEC_60317"))));
+        }},
+        {"GetOuterDiameterServedLitz", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetOuterDiameterServedLitz(arguments.get<double>(0, "conductingDiameter"), arguments.get<int>(1, "numberConductors"), arguments.get<int>(2, "grade", 1), arguments.get<int>(3, "numberLayers", 1), arguments.get<std::string>(4, "standardString", std::string("IEC_60317"))));
+        }},
+        {"GetOuterDiameterInsulatedLitz", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetOuterDiameterInsulatedLitz(arguments.get<double>(0, "conductingDiameter"), arguments.get<int>(1, "numberConductors"), arguments.get<int>(2, "numberLayers"), arguments.get<double>(3, "thicknessLayers"), arguments.get<int>(4, "grade", 1), arguments.get<std::string>(5, "standardString", std::string("IEC_60317"))));
+        }},
+        {"GetConductingAreaRectangular", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetConductingAreaRectangular(arguments.get<double>(0, "conductingWidth"), arguments.get<double>(1, "conductingHeight"), arguments.get<std::string>(2, "standardString", std::string("IEC_60317"))));
+        }},
+        {"GetOuterWidthRectangular", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetOuterWidthRectangular(arguments.get<double>(0, "conductingWidth"), arguments.get<int>(1, "grade", 1), arguments.get<std::string>(2, "standardString", std::string("IEC_60317"))));
+        }},
+        {"GetOuterHeightRectangular", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetOuterHeightRectangular(arguments.get<double>(0, "conductingHeight"), arguments.get<int>(1, "grade", 1), arguments.get<std::string>(2, "standardString", std::string("IEC_60317"))));
+        }},
+        {"CalculateCoreMaximumMagneticEnergy", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateCoreMaximumMagneticEnergy(arguments.get<std::string>(0, "coreDataString"), arguments.get<std::string>(1, "operatingPointString")));
+        }},
+        {"CalculateRequiredMagneticEnergy", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateRequiredMagneticEnergy(arguments.get<std::string>(0, "inputsString")));
+        }},
+        {"CalculateSaturationCurrent", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateSaturationCurrent(arguments.get<std::string>(0, "magneticString"), arguments.get<double>(1, "temperature")));
+        }},
+        {"CalculateTemperatureFromCoreThermalResistance", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateTemperatureFromCoreThermalResistance(arguments.get<std::string>(0, "coreString"), arguments.get<double>(1, "totalLosses")));
+        }},
+        {"CalculateSteadyStateTemperature", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CalculateSteadyStateTemperature(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "inputsString"), arguments.get<std::string>(2, "modelsString"), arguments.get<double>(3, "temperatureTolerance", 0.1), arguments.get<int>(4, "maximumNumberIterations", 50), arguments.get<double>(5, "initialTemperature", -300)));
+        }},
+        {"PlotField", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.PlotField(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "operatingPointString"), arguments.get<std::string>(2, "outFile")));
+        }},
+        {"PlotFieldPreview", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.PlotFieldPreview(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "operatingPointString"), arguments.get<std::string>(2, "outFile"), arguments.get<int>(3, "maximumNumberPrimitives", 2000)));
+        }},
+        {"PlotCore", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.PlotCore(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "outFile")));
+        }},
+        {"PlotSections", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.PlotSections(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "outFile")));
+        }},
+        {"PlotLayers", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.PlotLayers(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "outFile")));
+        }},
+        {"PlotTurns", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.PlotTurns(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "outFile")));
+        }},
+        {"PlotBatch", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.PlotBatch(arguments.get<std::string>(0, "plotJobsString"), arguments.get<int>(1, "numberThreads", 0)));
+        }},
+        {"PlotToString", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.PlotToString(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "plotKind"), arguments.get<std::string>(2, "operatingPointString", std::string())));
+        }},
+        {"PlotToCompressedString", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.PlotToCompressedString(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "plotKind"), arguments.get<std::string>(2, "operatingPointString", std::string())));
+        }},
+        {"GetSettings", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetSettings());
+        }},
+        {"SetSettings", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            mkfNet.SetSettings(arguments.get<std::string>(0, "settingsString"));
+            return std::string();
+        }},
+        {"ResetSettings", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            mkfNet.ResetSettings();
+            return std::string();
+        }},
+        {"StartJobs", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.StartJobs(arguments.get<int>(0, "numberWorkers", 0), arguments.get<int>(1, "queueCapacity", 256)));
+        }},
+        {"SubmitSimulate", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.SubmitSimulate(arguments.get<std::string>(0, "inputsString"), arguments.get<std::string>(1, "magneticString"), arguments.get<std::string>(2, "modelsData")));
+        }},
+        {"SubmitCalculateAdvisedCores", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.SubmitCalculateAdvisedCores(arguments.get<std::string>(0, "inputsString"), arguments.get<std::string>(1, "weightsString"), arguments.get<int>(2, "maximumNumberResults"), arguments.get<bool>(3, "useOnlyCoresInStock")));
+        }},
+        {"SubmitCalculateAdvisedMagnetics", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.SubmitCalculateAdvisedMagnetics(arguments.get<std::string>(0, "inputsString"), arguments.get<int>(1, "maximumNumberResults")));
+        }},
+        {"SubmitPlot", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.SubmitPlot(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "plotKind"), arguments.get<std::string>(2, "operatingPointString"), arguments.get<std::string>(3, "outFile")));
+        }},
+        {"SubmitPlotToString", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.SubmitPlotToString(arguments.get<std::string>(0, "magneticString"), arguments.get<std::string>(1, "plotKind"), arguments.get<std::string>(2, "operatingPointString", std::string())));
+        }},
+        {"PollJob", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.PollJob(arguments.get<int>(0, "jobId")));
+        }},
+        {"WaitJob", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.WaitJob(arguments.get<int>(0, "jobId"), arguments.get<int>(1, "timeoutMilliseconds", -1)));
+        }},
+        {"GetJobResult", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetJobResult(arguments.get<int>(0, "jobId")));
+        }},
+        {"CancelJob", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.CancelJob(arguments.get<int>(0, "jobId")));
+        }},
+        {"ReleaseJob", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.ReleaseJob(arguments.get<int>(0, "jobId")));
+        }},
+        {"GetMetrics", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetMetrics(arguments.get<bool>(0, "reset", false)));
+        }},
+        {"ResetMetrics", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            mkfNet.ResetMetrics();
+            return std::string();
+        }},
+        {"SetCallTracing", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            mkfNet.SetCallTracing(arguments.get<bool>(0, "enabled"));
+            return std::string();
+        }},
+        {"GetLastCallTrace", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetLastCallTrace());
+        }},
+        {"GetMemoryUsage", [](MKFNet& mkfNet, const OperationArguments& arguments) {
+            return to_result(mkfNet.GetMemoryUsage());
+        }},
+        };
+        return operations;
+    }
+}
+
+std::string dispatch_call(MKFNet& mkfNet, const std::string& operation, const std::string& argumentsJson) {
+    try {
+        auto& operations = get_operations();
+        auto operationIterator = operations.find(operation);
+        if (operationIterator == operations.end()) {
+            throw std::invalid_argument("Unknown operation " + operation);
+        }
+        json arguments = argumentsJson.empty()? json::object() : json::parse(argumentsJson);
+        if (!arguments.is_object() && !arguments.is_array()) {
+            throw std::invalid_argument("Arguments of " + operation + " must be a JSON object or array");
+        }
+        return operationIterator->second(mkfNet, OperationArguments(arguments));
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+std::string dispatch_call(MKFNet& mkfNet, const std::string& operation, const std::vector<const char*>& textArguments) {
+    try {
+        auto& operations = get_operations();
+        auto operationIterator = operations.find(operation);
+        if (operationIterator == operations.end()) {
+            throw std::invalid_argument("Unknown operation " + operation);
+        }
+        return operationIterator->second(mkfNet, OperationArguments(textArguments));
+    }
+    catch (const std::exception &exc) {
+        return "Exception: " + std::string{exc.what()};
+    }
+}
+
+std::vector<std::string> get_operation_names() {
+    std::vector<std::string> operationNames;
+    for (auto& [operationName, operation] : get_operations()) {
+        operationNames.push_back(operationName);
+    }
+    return operationNames;
+}
+
+bool has_operation(const std::string& operation) {
+    return get_operations().contains(operation);
+}
+
+bool is_exclusive_operation(const std::string& operation) {
+    static const std::set<std::string> exclusiveOperations = {
+        "LoadDatabases", "ReadDatabases", "ReadCatalogSnapshot",
+        "LoadCore", "UnloadCore", "CalculateCoreData", "CalculateCoreProcessedDescription", "CalculateCoreGeometricalDescription", "CalculateCoreGapping",
+        "SetSettings", "ResetSettings", "CalculateAdvisedCores", "PlotBatch",
+        "StartJobs"
+    };
+    return exclusiveOperations.contains(operation);
+}
+
+bool is_file_operation(const std::string& operation) {
+    static const std::set<std::string> fileOperations = {
+        "LoadMagneticsFromFile", "ReadDatabases", "WriteCatalogSnapshot", "ReadCatalogSnapshot",
+        "PlotField", "PlotFieldPreview", "PlotCore", "PlotSections", "PlotLayers", "PlotTurns", "PlotBatch", "SubmitPlot"
+    };
+    return fileOperations.contains(operation);
+}
+
+bool is_job_control_operation(const std::string& operation) {
+    static const std::set<std::string> jobControlOperations = {
+        "PollJob", "WaitJob", "GetJobResult", "CancelJob", "ReleaseJob"
+    };
+    return jobControlOperations.contains(operation);
+}
+
+std::optional<size_t> parse_count(const std::string& argument) {
+    if (argument.empty() || argument.find_first_not_of("0123456789") != std::string::npos) {
+        return std::nullopt;
+    }
+    try {
+        return std::stoul(argument);
+    }
+    catch (const std::out_of_range&) {
+        return std::nullopt;
+    }
+}
+
+int print_usage(const std::string& usage) {
+    std::cerr << "Usage: " << usage << std::endl;
+    return 2;
+}
+
+std::string warm_up_catalogs(MKFNet& mkfNet, const std::string& databasesPath) {
+    if (!databasesPath.empty()) {
+        auto result = std::filesystem::is_regular_file(databasesPath)? mkfNet.ReadCatalogSnapshot(databasesPath, false) : mkfNet.ReadDatabases(databasesPath, true);
+        if (result != "0") {
+            return result;
+        }
+    }
+    mkfNet.GetCoreMaterialNames();
+    mkfNet.GetCoreShapeNames();
+    mkfNet.GetWireNames();
+    mkfNet.GetBobbinNames();
+    mkfNet.GetInsulationMaterialNames();
+    mkfNet.GetWireMaterialNames();
+    return "";
+}
+
+std::string OperationRunner::call(const std::string& operation, const std::string& argumentsJson) {
+    if (!_allowFileOperations && is_file_operation(operation)) {
+        return "Exception: " + operation + " reads or writes files and is not allowed here";
+    }
+    MKFNet mkfNet;
+    if (is_exclusive_operation(operation)) {
+        std::unique_lock<std::shared_mutex> lock(_exclusiveMutex);
+        return dispatch_call(mkfNet, operation, argumentsJson);
+    }
+    std::shared_lock<std::shared_mutex> lock(_exclusiveMutex);
+    return dispatch_call(mkfNet, operation, argumentsJson);
+}
+
+std::string OperationRunner::run_job(const std::string& job, size_t index, bool& failed) {
+    json record;
+    record["index"] = index;
+    try {
+        json jobJson = json::parse(job);
+        if (jobJson.contains("id")) {
+            record["id"] = jobJson["id"];
+        }
+        std::string operation = jobJson.at("operation");
+        record["operation"] = operation;
+        std::string arguments = jobJson.contains("arguments")? jobJson["arguments"].dump() : "";
+
+        auto start = std::chrono::steady_clock::now();
+        auto result = call(operation, arguments);
+        record["milliseconds"] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (result.starts_with("Exception: ")) {
+            record["error"] = result.substr(std::string("Exception: ").size());
+        }
+        else {
+            // Results that are JSON documents are embedded as such, anything else as a string
+            auto resultJson = json::parse(result, nullptr, false);
+            record["result"] = resultJson.is_discarded()? json(result) : resultJson;
+        }
+    }
+    catch (const std::exception &exc) {
+        record["error"] = std::string{exc.what()};
+    }
+    failed = record.contains("error");
+    return record.dump(-1, ' ', false, json::error_handler_t::replace);
+}
+
+} // namespace MKFNetInternal
@@ -0,0 +1,62 @@
+#pragma once
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+class MKFNet;
+
+namespace MKFNetInternal {
+
+// Runs the MKFNet method named by operation. Arguments are a JSON object keyed by the parameter names
+// in MKFNet.h, or a JSON array in declaration order; string parameters also accept any JSON value,
+// which is passed on serialized. Numbers and booleans are returned as JSON text, void methods as "",
+// and any failure as "Exception: ...", as the methods themselves do
+std::string dispatch_call(MKFNet& mkfNet, const std::string& operation, const std::string& argumentsJson);
+
+// Same with one text per parameter in declaration order. String parameters take their text as is, so documents
+// are never parsed or serialized on the way; other parameters parse theirs as JSON. Null or missing texts take the default
+std::string dispatch_call(MKFNet& mkfNet, const std::string& operation, const std::vector<const char*>& textArguments);
+
+std::vector<std::string> get_operation_names();
+bool has_operation(const std::string& operation);
+
+// Operations that change the global settings, load catalogs or edit core handles,
+// which callers running operations concurrently must not overlap with any other
+bool is_exclusive_operation(const std::string& operation);
+
+// Operations that read or write files named in their arguments
+bool is_file_operation(const std::string& operation);
+
+// Operations that look at, wait for or drop jobs of the job system. WaitJob can block for as long as the job runs,
+// so callers with a fixed set of workers run these on threads of their own
+bool is_job_control_operation(const std::string& operation);
+
+// Reads the catalogs of databasesPath, a MAS data directory or a catalog snapshot file, if not empty, or the
+// embedded ones otherwise, so that later calls find them loaded. Returns "" or the reason they could not be read
+std::string warm_up_catalogs(MKFNet& mkfNet, const std::string& databasesPath);
+
+// A whole decimal count; std::stoul alone would take "4x" as 4 and "-1" as a huge count
+std::optional<size_t> parse_count(const std::string& argument);
+
+// Writes the usage line of a command line runner to stderr and returns the exit code of a usage error
+int print_usage(const std::string& usage);
+
+// Runs operations from many threads at once, letting exclusive operations wait for every other one
+// and hold off new ones until they finish. File operations fail unless allowed
+class OperationRunner {
+    private:
+        std::shared_mutex _exclusiveMutex;
+        bool _allowFileOperations;
+
+    public:
+        explicit OperationRunner(bool allowFileOperations = true) : _allowFileOperations(allowFileOperations) {}
+
+        std::string call(const std::string& operation, const std::string& argumentsJson);
+
+        // Runs one {"id": ..., "operation": ..., "arguments": {...}} job and returns its result line,
+        // {"index": ..., "id": ..., "operation": ..., "milliseconds": ..., "result": ...} or with "error" instead of "result"
+        std::string run_job(const std::string& job, size_t index, bool& failed);
+};
+
+} // namespace MKFNetInternal
@@ -0,0 +1,481 @@
+#include "MagneticOptimizer.h"
+#include "BobbinWrapper.h"
+#include "CoilWrapper.h"
+#include "CoreWrapper.h"
+#include "Temperature.h"
+#include "ThreadPool.h"
+#include "WireGeometry.h"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <set>
+
+namespace MKFNetInternal {
+
+namespace {
+    const double residualGapLength = 5e-6;
+    // Tolerance applied to an inductance requirement given only as nominal
+    const double defaultRequirementTolerance = 0.1;
+    // Densities used to turn volumes into a mass, which stands in for cost as the catalogs carry no prices
+    const double ferriteDensity = 4800;
+    const double copperDensity = 8960;
+    const double unwindableViolation = 5;
+    const double failedEvaluationViolation = 10;
+
+    double getRequirementViolation(const OpenMagnetics::DimensionWithTolerance& requirement, double value) {
+        double minimum = -std::numeric_limits<double>::infinity();
+        double maximum = std::numeric_limits<double>::infinity();
+        if (requirement.get_minimum()) {
+            minimum = requirement.get_minimum().value();
+        }
+        if (requirement.get_maximum()) {
+            maximum = requirement.get_maximum().value();
+        }
+        if (!requirement.get_minimum() && !requirement.get_maximum() && requirement.get_nominal()) {
+            minimum = requirement.get_nominal().value() * (1 - defaultRequirementTolerance);
+            maximum = requirement.get_nominal().value() * (1 + defaultRequirementTolerance);
+        }
+        if (value < minimum) {
+            return (minimum - value) / std::abs(minimum);
+        }
+        if (value > maximum) {
+            return (value - maximum) / std::abs(maximum);
+        }
+        return 0;
+    }
+
+    // Feasible designs dominate infeasible ones, and infeasible ones are compared by how far they are from feasibility
+    bool dominates(const OptimizerEvaluation& first, const OptimizerEvaluation& second) {
+        if (first.constraintViolation > 0 || second.constraintViolation > 0) {
+            return first.constraintViolation < second.constraintViolation;
+        }
+        bool strictlyBetter = false;
+        for (size_t objectiveIndex = 0; objectiveIndex < first.objectives.size(); objectiveIndex++) {
+            if (first.objectives[objectiveIndex] > second.objectives[objectiveIndex]) {
+                return false;
+            }
+            if (first.objectives[objectiveIndex] < second.objectives[objectiveIndex]) {
+                strictlyBetter = true;
+            }
+        }
+        return strictlyBetter;
+    }
+}
+
+MagneticOptimizer::MagneticOptimizer(OpenMagnetics::InputsWrapper inputs, OpenMagnetics::MagneticSimulator magneticSimulator, json settings) : _inputs(inputs), _magneticSimulator(magneticSimulator) {
+    // Counts are read signed, so that a negative one is reported instead of wrapping around
+    int64_t populationSize = settings.value("populationSize", int64_t(_populationSize));
+    if (populationSize < 4) {
+        throw std::invalid_argument("populationSize must be at least 4");
+    }
+    _populationSize = size_t(populationSize);
+    int64_t numberGenerations = settings.value("numberGenerations", int64_t(_numberGenerations));
+    if (numberGenerations < 0) {
+        throw std::invalid_argument("numberGenerations cannot be negative");
+    }
+    _numberGenerations = size_t(numberGenerations);
+    _seed = settings.value("seed", _seed);
+    _gapStep = settings.value("gapStep", _gapStep);
+    if (!std::isfinite(_gapStep) || _gapStep <= 0) {
+        throw std::invalid_argument("gapStep must be positive");
+    }
+    double maximumGapLength = settings.value("maximumGapLength", _maximumGapSteps * _gapStep);
+    if (!std::isfinite(maximumGapLength) || maximumGapLength < 0) {
+        throw std::invalid_argument("maximumGapLength cannot be negative");
+    }
+    _maximumGapSteps = int64_t(std::round(maximumGapLength / _gapStep));
+    _minimumNumberTurns = settings.value("minimumNumberTurns", _minimumNumberTurns);
+    _maximumNumberTurns = settings.value("maximumNumberTurns", _maximumNumberTurns);
+    if (_minimumNumberTurns < 1 || _maximumNumberTurns < _minimumNumberTurns) {
+        throw std::invalid_argument("Number of turns must satisfy 1 <= minimumNumberTurns <= maximumNumberTurns");
+    }
+    _maximumTemperature = settings.value("maximumTemperature", _maximumTemperature);
+    if (!std::isfinite(_maximumTemperature) || _maximumTemperature <= 0) {
+        throw std::invalid_argument("maximumTemperature must be positive");
+    }
+    _crossoverProbability = settings.value("crossoverProbability", _crossoverProbability);
+    _mutationProbability = settings.value("mutationProbability", _mutationProbability);
+    for (auto probability : {_crossoverProbability, _mutationProbability}) {
+        if (!(probability >= 0 && probability <= 1)) {
+            throw std::invalid_argument("crossoverProbability and mutationProbability must be between 0 and 1");
+        }
+    }
+    _randomEngine.seed(_seed);
+
+    if (settings.contains("shapes")) {
+        _shapeNames = settings["shapes"].get<std::vector<std::string>>();
+    }
+    else {
+        // Toroids are wound and gapped differently from the two-piece sets the genome describes
+        for (auto& shapeName : OpenMagnetics::get_shape_names()) {
+            try {
+                if (OpenMagnetics::find_core_shape_by_name(shapeName).get_family() != OpenMagnetics::CoreShapeFamily::T) {
+                    _shapeNames.push_back(shapeName);
+                }
+            }
+            catch (...) {
+                continue;
+            }
+        }
+    }
+    _materialNames = settings.contains("materials")? settings["materials"].get<std::vector<std::string>>() : OpenMagnetics::get_material_names(std::nullopt);
+    _wireNames = settings.contains("wires")? settings["wires"].get<std::vector<std::string>>() : OpenMagnetics::get_wire_names();
+    if (_shapeNames.empty() || _materialNames.empty() || _wireNames.empty()) {
+        throw std::invalid_argument("Optimizer needs at least one shape, one material and one wire");
+    }
+}
+
+OpenMagnetics::MagneticWrapper MagneticOptimizer::create_magnetic(const OptimizerGenome& genome) const {
+    json coreJson;
+    coreJson["name"] = "Optimized " + get_shape_name(genome);
+    coreJson["functionalDescription"]["type"] = "two-piece set";
+    coreJson["functionalDescription"]["shape"] = get_shape_name(genome);
+    coreJson["functionalDescription"]["material"] = get_material_name(genome);
+    coreJson["functionalDescription"]["numberStacks"] = 1;
+    coreJson["functionalDescription"]["gapping"] = json::array();
+    OpenMagnetics::CoreWrapper core(coreJson);
+    if (!core.get_processed_description()) {
+        core.process_data();
+    }
+
+    // Ground gap in the central column, residual gaps in the rest
+    double gapLength = get_gap_length(genome);
+    json gappingJson = json::array();
+    for (size_t columnIndex = 0; columnIndex < core.get_processed_description()->get_columns().size(); columnIndex++) {
+        if (columnIndex == 0 && gapLength > residualGapLength) {
+            gappingJson.push_back({{"type", "subtractive"}, {"length", gapLength}});
+        }
+        else {
+            gappingJson.push_back({{"type", "residual"}, {"length", residualGapLength}});
+        }
+    }
+    core.get_mutable_functional_description().set_gapping(gappingJson.get<std::vector<OpenMagnetics::CoreGap>>());
+    core.process_gap();
+
+    json coilJson;
+    to_json(coilJson["bobbin"], OpenMagnetics::BobbinWrapper::create_quick_bobbin(core));
+    coilJson["functionalDescription"] = json::array();
+    auto turnsRatios = _inputs.get_design_requirements().get_turns_ratios();
+    auto isolationSides = magic_enum::enum_values<OpenMagnetics::IsolationSide>();
+    for (size_t windingIndex = 0; windingIndex <= turnsRatios.size(); windingIndex++) {
+        int64_t numberTurns = genome.numberTurns;
+        if (windingIndex > 0) {
+            double turnsRatio = OpenMagnetics::resolve_dimensional_values(turnsRatios[windingIndex - 1]);
+            numberTurns = std::max(int64_t(1), int64_t(std::round(genome.numberTurns / turnsRatio)));
+        }
+        json windingJson;
+        windingJson["name"] = "Winding " + std::to_string(windingIndex);
+        windingJson["numberTurns"] = numberTurns;
+        windingJson["numberParallels"] = 1;
+        to_json(windingJson["isolationSide"], isolationSides[std::min(windingIndex, isolationSides.size() - 1)]);
+        windingJson["wire"] = get_wire_name(genome);
+        coilJson["functionalDescription"].push_back(windingJson);
+    }
+    OpenMagnetics::CoilWrapper coil(coilJson);
+    if (!coil.get_turns_description()) {
+        coil.wind();
+    }
+
+    OpenMagnetics::MagneticWrapper magnetic;
+    magnetic.set_core(core);
+    magnetic.set_coil(coil);
+    return magnetic;
+}
+
+OptimizerEvaluation MagneticOptimizer::evaluate(const OptimizerGenome& genome) const {
+    OptimizerEvaluation evaluation;
+    evaluation.objectives.fill(std::numeric_limits<double>::infinity());
+    try {
+        auto magnetic = create_magnetic(genome);
+        auto coil = magnetic.get_coil();
+        if (!coil.get_turns_description() || !coil.are_sections_and_layers_fitting()) {
+            evaluation.constraintViolation = unwindableViolation;
+            return evaluation;
+        }
+
+        auto magneticSimulator = _magneticSimulator;
+        auto operatingPoints = _inputs.get_operating_points();
+        auto magnetizingInductanceRequirement = _inputs.get_design_requirements().get_magnetizing_inductance();
+
+        // Inductance is cheap next to the loss models, so designs missing the requirement are pruned before those run
+        std::vector<OpenMagnetics::Outputs> outputs(operatingPoints.size());
+        double constraintViolation = 0;
+        for (size_t operatingPointIndex = 0; operatingPointIndex < operatingPoints.size(); operatingPointIndex++) {
+            auto magnetizingInductanceOutput = magneticSimulator.calculate_magnetizing_inductance(operatingPoints[operatingPointIndex], magnetic);
+            double magnetizingInductance = OpenMagnetics::resolve_dimensional_values(magnetizingInductanceOutput.get_magnetizing_inductance());
+            constraintViolation = std::max(constraintViolation, getRequirementViolation(magnetizingInductanceRequirement, magnetizingInductance));
+            outputs[operatingPointIndex].set_magnetizing_inductance(magnetizingInductanceOutput);
+        }
+        if (constraintViolation > 0) {
+            evaluation.constraintViolation = constraintViolation;
+            return evaluation;
+        }
+
+        auto core = magnetic.get_core();
+        double maximumLosses = 0;
+        double maximumTemperature = -std::numeric_limits<double>::infinity();
+        for (size_t operatingPointIndex = 0; operatingPointIndex < operatingPoints.size(); operatingPointIndex++) {
+            auto& operatingPoint = operatingPoints[operatingPointIndex];
+            double ambientTemperature = operatingPoint.get_conditions().get_ambient_temperature();
+            auto coreLossesOutput = magneticSimulator.calculate_core_losses(operatingPoint, magnetic);
+            auto windingLossesOutput = magneticSimulator.calculate_winding_losses(operatingPoint, magnetic, ambientTemperature);
+            double totalLosses = coreLossesOutput.get_core_losses() + windingLossesOutput.get_winding_losses();
+            double temperature = ambientTemperature + OpenMagnetics::Temperature::calculate_temperature_from_core_thermal_resistance(core, totalLosses);
+            if (coreLossesOutput.get_temperature()) {
+                temperature = std::max(temperature, coreLossesOutput.get_temperature().value());
+            }
+            maximumLosses = std::max(maximumLosses, totalLosses);
+            maximumTemperature = std::max(maximumTemperature, temperature);
+            outputs[operatingPointIndex].set_core_losses(coreLossesOutput);
+            outputs[operatingPointIndex].set_winding_losses(windingLossesOutput);
+        }
+        if (maximumTemperature > _maximumTemperature) {
+            evaluation.constraintViolation = (maximumTemperature - _maximumTemperature) / _maximumTemperature;
+            return evaluation;
+        }
+
+        auto processedDescription = core.get_processed_description().value();
+        double boxedVolume = processedDescription.get_width() * processedDescription.get_height() * processedDescription.get_depth();
+        double coreVolume = processedDescription.get_effective_parameters().get_effective_volume();
+        // Each turn is one parallel of its winding and carries the copper of one wire
+        std::map<std::string, double> conductingAreaPerWinding;
+        for (size_t windingIndex = 0; windingIndex < coil.get_functional_description().size(); windingIndex++) {
+            auto wire = coil.resolve_wire(windingIndex);
+            conductingAreaPerWinding[coil.get_functional_description()[windingIndex].get_name()] = get_wire_conducting_area(wire);
+        }
+        double conductorVolume = 0;
+        for (auto& turn : coil.get_turns_description().value()) {
+            conductorVolume += turn.get_length() * conductingAreaPerWinding.at(turn.get_winding());
+        }
+
+        evaluation.objectives[size_t(OptimizerObjective::LOSSES)] = maximumLosses;
+        evaluation.objectives[size_t(OptimizerObjective::VOLUME)] = boxedVolume;
+        evaluation.objectives[size_t(OptimizerObjective::TEMPERATURE)] = maximumTemperature;
+        evaluation.objectives[size_t(OptimizerObjective::COST)] = coreVolume * ferriteDensity + conductorVolume * copperDensity;
+
+        OpenMagnetics::MasWrapper mas;
+        mas.set_inputs(_inputs);
+        mas.set_magnetic(magnetic);
+        mas.set_outputs(outputs);
+        evaluation.mas = mas;
+    }
+    catch (...) {
+        evaluation.constraintViolation = failedEvaluationViolation;
+    }
+    return evaluation;
+}
+
+void MagneticOptimizer::evaluate_population(std::vector<OptimizerIndividual>& population, ThreadPool& pool) {
+    std::vector<OptimizerGenome> pendingGenomes;
+    for (auto& individual : population) {
+        if (!_evaluations.contains(individual.genome) && std::find(pendingGenomes.begin(), pendingGenomes.end(), individual.genome) == pendingGenomes.end()) {
+            pendingGenomes.push_back(individual.genome);
+        }
+    }
+
+    if (!pendingGenomes.empty()) {
+        std::vector<std::future<OptimizerEvaluation>> evaluations;
+        for (auto& genome : pendingGenomes) {
+            evaluations.push_back(pool.submit([this, &genome]() {
+                return evaluate(genome);
+            }));
+        }
+        for (size_t genomeIndex = 0; genomeIndex < pendingGenomes.size(); genomeIndex++) {
+            _evaluations[pendingGenomes[genomeIndex]] = std::make_shared<const OptimizerEvaluation>(evaluations[genomeIndex].get());
+        }
+    }
+
+    for (auto& individual : population) {
+        individual.evaluation = _evaluations[individual.genome];
+    }
+}
+
+std::vector<std::vector<size_t>> MagneticOptimizer::sort_by_dominance(std::vector<OptimizerIndividual>& population) {
+    std::vector<std::vector<size_t>> dominatedIndexes(population.size());
+    std::vector<size_t> numberDominating(population.size(), 0);
+    std::vector<std::vector<size_t>> fronts(1);
+    for (size_t firstIndex = 0; firstIndex < population.size(); firstIndex++) {
+        for (size_t secondIndex = 0; secondIndex < population.size(); secondIndex++) {
+            if (dominates(*population[firstIndex].evaluation, *population[secondIndex].evaluation)) {
+                dominatedIndexes[firstIndex].push_back(secondIndex);
+            }
+            else if (dominates(*population[secondIndex].evaluation, *population[firstIndex].evaluation)) {
+                numberDominating[firstIndex]++;
+            }
+        }
+        if (numberDominating[firstIndex] == 0) {
+            fronts[0].push_back(firstIndex);
+        }
+    }
+    while (!fronts.back().empty()) {
+        std::vector<size_t> nextFront;
+        for (auto individualIndex : fronts.back()) {
+            population[individualIndex].rank = fronts.size() - 1;
+            for (auto dominatedIndex : dominatedIndexes[individualIndex]) {
+                if (--numberDominating[dominatedIndex] == 0) {
+                    nextFront.push_back(dominatedIndex);
+                }
+            }
+        }
+        fronts.push_back(nextFront);
+    }
+    fronts.pop_back();
+
+    // Crowding distance, only meaningful among feasible designs; infeasible ones in a front share the same violation
+    for (auto& front : fronts) {
+        for (auto individualIndex : front) {
+            population[individualIndex].crowdingDistance = 0;
+        }
+        if (population[front[0]].evaluation->constraintViolation > 0) {
+            continue;
+        }
+        for (size_t objectiveIndex = 0; objectiveIndex < 4; objectiveIndex++) {
+            auto sortedFront = front;
+            std::stable_sort(sortedFront.begin(), sortedFront.end(), [&](size_t first, size_t second) {
+                return population[first].evaluation->objectives[objectiveIndex] < population[second].evaluation->objectives[objectiveIndex];
+            });
+            double minimum = population[sortedFront.front()].evaluation->objectives[objectiveIndex];
+            double maximum = population[sortedFront.back()].evaluation->objectives[objectiveIndex];
+            population[sortedFront.front()].crowdingDistance = std::numeric_limits<double>::infinity();
+            population[sortedFront.back()].crowdingDistance = std::numeric_limits<double>::infinity();
+            if (maximum <= minimum) {
+                continue;
+            }
+            for (size_t position = 1; position + 1 < sortedFront.size(); position++) {
+                double previous = population[sortedFront[position - 1]].evaluation->objectives[objectiveIndex];
+                double next = population[sortedFront[position + 1]].evaluation->objectives[objectiveIndex];
+                population[sortedFront[position]].crowdingDistance += (next - previous) / (maximum - minimum);
+            }
+        }
+    }
+    return fronts;
+}
+
+OptimizerGenome MagneticOptimizer::create_random_genome() {
+    OptimizerGenome genome;
+    genome.shapeIndex = std::uniform_int_distribution<size_t>(0, _shapeNames.size() - 1)(_randomEngine);
+    genome.materialIndex = std::uniform_int_distribution<size_t>(0, _materialNames.size() - 1)(_randomEngine);
+    genome.wireIndex = std::uniform_int_distribution<size_t>(0, _wireNames.size() - 1)(_randomEngine);
+    genome.gapSteps = std::uniform_int_distribution<int64_t>(0, _maximumGapSteps)(_randomEngine);
+    genome.numberTurns = std::uniform_int_distribution<int64_t>(_minimumNumberTurns, _maximumNumberTurns)(_randomEngine);
+    return genome;
+}
+
+const OptimizerIndividual& MagneticOptimizer::select_by_tournament(const std::vector<OptimizerIndividual>& population) {
+    std::uniform_int_distribution<size_t> pick(0, population.size() - 1);
+    auto& first = population[pick(_randomEngine)];
+    auto& second = population[pick(_randomEngine)];
+    if (first.rank != second.rank) {
+        return first.rank < second.rank? first : second;
+    }
+    return first.crowdingDistance >= second.crowdingDistance? first : second;
+}
+
+OptimizerGenome MagneticOptimizer::create_offspring(const OptimizerIndividual& firstParent, const OptimizerIndividual& secondParent) {
+    std::uniform_real_distribution<double> unit(0, 1);
+    OptimizerGenome genome = firstParent.genome;
+    if (unit(_randomEngine) < _crossoverProbability) {
+        // Catalog indexes are inherited whole, ordered genes are blended slightly beyond their parents
+        auto& other = secondParent.genome;
+        if (unit(_randomEngine) < 0.5) {
+            genome.shapeIndex = other.shapeIndex;
+        }
+        if (unit(_randomEngine) < 0.5) {
+            genome.materialIndex = other.materialIndex;
+        }
+        if (unit(_randomEngine) < 0.5) {
+            genome.wireIndex = other.wireIndex;
+        }
+        auto blend = [&](int64_t first, int64_t second) {
+            double weight = std::uniform_real_distribution<double>(-0.25, 1.25)(_randomEngine);
+            return int64_t(std::round(first + weight * (second - first)));
+        };
+        genome.gapSteps = blend(genome.gapSteps, other.gapSteps);
+        genome.numberTurns = blend(genome.numberTurns, other.numberTurns);
+    }
+
+    if (unit(_randomEngine) < _mutationProbability) {
+        genome.shapeIndex = std::uniform_int_distribution<size_t>(0, _shapeNames.size() - 1)(_randomEngine);
+    }
+    if (unit(_randomEngine) < _mutationProbability) {
+        genome.materialIndex = std::uniform_int_distribution<size_t>(0, _materialNames.size() - 1)(_randomEngine);
+    }
+    if (unit(_randomEngine) < _mutationProbability) {
+        genome.wireIndex = std::uniform_int_distribution<size_t>(0, _wireNames.size() - 1)(_randomEngine);
+    }
+    auto perturb = [&](int64_t value, int64_t minimum, int64_t maximum) {
+        double deviation = std::max(1.0, 0.1 * (maximum - minimum));
+        return value + int64_t(std::round(std::normal_distribution<double>(0, deviation)(_randomEngine)));
+    };
+    if (unit(_randomEngine) < _mutationProbability) {
+        genome.gapSteps = perturb(genome.gapSteps, 0, _maximumGapSteps);
+    }
+    if (unit(_randomEngine) < _mutationProbability) {
+        genome.numberTurns = perturb(genome.numberTurns, _minimumNumberTurns, _maximumNumberTurns);
+    }
+
+    genome.gapSteps = std::clamp(genome.gapSteps, int64_t(0), _maximumGapSteps);
+    genome.numberTurns = std::clamp(genome.numberTurns, _minimumNumberTurns, _maximumNumberTurns);
+    return genome;
+}
+
+std::vector<OptimizerIndividual> MagneticOptimizer::optimize(size_t numberThreads) {
+    if (numberThreads == 0) {
+        numberThreads = ThreadPool::is_worker_thread()? 1 : std::max(1u, std::thread::hardware_concurrency());
+    }
+    // No generation evaluates more new designs than the population size
+    ThreadPool pool(std::min(numberThreads, _populationSize));
+
+    std::vector<OptimizerIndividual> population(_populationSize);
+    for (auto& individual : population) {
+        individual.genome = create_random_genome();
+    }
+    evaluate_population(population, pool);
+    sort_by_dominance(population);
+
+    for (size_t generation = 0; generation < _numberGenerations; generation++) {
+        std::vector<OptimizerIndividual> offspring(_populationSize);
+        for (auto& child : offspring) {
+            auto& firstParent = select_by_tournament(population);
+            auto& secondParent = select_by_tournament(population);
+            child.genome = create_offspring(firstParent, secondParent);
+        }
+        evaluate_population(offspring, pool);
+
+        std::vector<OptimizerIndividual> merged = population;
+        merged.insert(merged.end(), offspring.begin(), offspring.end());
+        auto fronts = sort_by_dominance(merged);
+
+        std::vector<OptimizerIndividual> survivors;
+        for (auto& front : fronts) {
+            if (survivors.size() + front.size() > _populationSize) {
+                std::stable_sort(front.begin(), front.end(), [&merged](size_t first, size_t second) {
+                    return merged[first].crowdingDistance > merged[second].crowdingDistance;
+                });
+            }
+            for (auto individualIndex : front) {
+                if (survivors.size() == _populationSize) {
+                    break;
+                }
+                survivors.push_back(merged[individualIndex]);
+            }
+        }
+        population = std::move(survivors);
+        sort_by_dominance(population);
+    }
+
+    std::vector<OptimizerIndividual> paretoFront;
+    std::set<OptimizerGenome> includedGenomes;
+    for (auto& individual : population) {
+        if (individual.rank == 0 && individual.evaluation->constraintViolation == 0 && includedGenomes.insert(individual.genome).second) {
+            paretoFront.push_back(individual);
+        }
+    }
+    std::stable_sort(paretoFront.begin(), paretoFront.end(), [](const OptimizerIndividual& first, const OptimizerIndividual& second) {
+        return first.evaluation->objectives[size_t(OptimizerObjective::LOSSES)] < second.evaluation->objectives[size_t(OptimizerObjective::LOSSES)];
+    });
+    return paretoFront;
+}
+
+} // namespace MKFNetInternal
@@ -0,0 +1,100 @@
+#pragma once
+#include "InputsWrapper.h"
+#include "MagneticSimulator.h"
+#include "MasWrapper.h"
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace MKFNetInternal {
+
+class ThreadPool;
+
+// One candidate design as indexes into the searched catalogs; the gap is ground in fixed steps so that every gene is discrete
+struct OptimizerGenome {
+    size_t shapeIndex;
+    size_t materialIndex;
+    size_t wireIndex;
+    int64_t gapSteps;
+    int64_t numberTurns;
+
+    auto operator<=>(const OptimizerGenome&) const = default;
+};
+
+enum class OptimizerObjective : size_t {
+    LOSSES,
+    VOLUME,
+    TEMPERATURE,
+    COST
+};
+
+struct OptimizerEvaluation {
+    std::array<double, 4> objectives;
+    // Zero for feasible designs. Otherwise the relative violation of the first check failed, in order the inductance at its
+    // worst operating point and then the temperature, or a fixed penalty for designs that cannot be wound or simulated
+    double constraintViolation = 0;
+    std::optional<OpenMagnetics::MasWrapper> mas;
+};
+
+struct OptimizerIndividual {
+    OptimizerGenome genome;
+    std::shared_ptr<const OptimizerEvaluation> evaluation;
+    size_t rank = 0;
+    double crowdingDistance = 0;
+};
+
+// NSGA-II search over core shape, core material, gap, number of turns and wire, minimizing losses, volume, temperature and cost.
+// Runs are reproducible for a given seed, whatever the number of threads
+class MagneticOptimizer {
+    private:
+        OpenMagnetics::InputsWrapper _inputs;
+        OpenMagnetics::MagneticSimulator _magneticSimulator;
+        std::vector<std::string> _shapeNames;
+        std::vector<std::string> _materialNames;
+        std::vector<std::string> _wireNames;
+        size_t _populationSize = 40;
+        size_t _numberGenerations = 20;
+        uint64_t _seed = 1;
+        double _gapStep = 1e-5;
+        int64_t _maximumGapSteps = 200;
+        int64_t _minimumNumberTurns = 1;
+        int64_t _maximumNumberTurns = 100;
+        double _maximumTemperature = 100;
+        double _crossoverProbability = 0.9;
+        double _mutationProbability = 0.2;
+        std::mt19937_64 _randomEngine;
+        std::map<OptimizerGenome, std::shared_ptr<const OptimizerEvaluation>> _evaluations;
+
+        OptimizerGenome create_random_genome();
+        OptimizerGenome create_offspring(const OptimizerIndividual& firstParent, const OptimizerIndividual& secondParent);
+        const OptimizerIndividual& select_by_tournament(const std::vector<OptimizerIndividual>& population);
+        OptimizerEvaluation evaluate(const OptimizerGenome& genome) const;
+        void evaluate_population(std::vector<OptimizerIndividual>& population, ThreadPool& pool);
+        static std::vector<std::vector<size_t>> sort_by_dominance(std::vector<OptimizerIndividual>& population);
+
+    public:
+        // Settings: populationSize, numberGenerations, seed, shapes, materials, wires (catalog names, all by default),
+        // gapStep, maximumGapLength, minimumNumberTurns, maximumNumberTurns, maximumTemperature, crossoverProbability, mutationProbability.
+        // Throws std::invalid_argument for settings out of range
+        MagneticOptimizer(OpenMagnetics::InputsWrapper inputs, OpenMagnetics::MagneticSimulator magneticSimulator, json settings);
+
+        std::string get_shape_name(const OptimizerGenome& genome) const { return _shapeNames[genome.shapeIndex]; }
+        std::string get_material_name(const OptimizerGenome& genome) const { return _materialNames[genome.materialIndex]; }
+        std::string get_wire_name(const OptimizerGenome& genome) const { return _wireNames[genome.wireIndex]; }
+        double get_gap_length(const OptimizerGenome& genome) const { return genome.gapSteps * _gapStep; }
+        size_t get_number_evaluations() const { return _evaluations.size(); }
+
+        OpenMagnetics::MagneticWrapper create_magnetic(const OptimizerGenome& genome) const;
+
+        // Feasible non-dominated designs of the last generation. Evaluations run on one pool of at most numberThreads threads,
+        // 0 meaning every core, or a single thread when the caller is already a worker
+        std::vector<OptimizerIndividual> optimize(size_t numberThreads = 0);
+};
+
+} // namespace MKFNetInternal
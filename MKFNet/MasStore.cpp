@@ -0,0 +1,104 @@
+#include "MasStore.h"
+#include <optional>
+#include <variant>
+
+namespace MKFNetInternal {
+
+namespace {
+    InternPool<OpenMagnetics::InputsWrapper>& get_inputs_pool() {
+        static InternPool<OpenMagnetics::InputsWrapper> inputsPool;
+        return inputsPool;
+    }
+
+    InternPool<OpenMagnetics::CoreMaterial>& get_core_material_pool() {
+        static InternPool<OpenMagnetics::CoreMaterial> coreMaterialPool;
+        return coreMaterialPool;
+    }
+
+    InternPool<OpenMagnetics::CoreShape>& get_core_shape_pool() {
+        static InternPool<OpenMagnetics::CoreShape> coreShapePool;
+        return coreShapePool;
+    }
+
+    InternPool<OpenMagnetics::Wire>& get_wire_pool() {
+        static InternPool<OpenMagnetics::Wire> wirePool;
+        return wirePool;
+    }
+
+    std::string get_part_name(const std::string& name) {
+        return name;
+    }
+
+    std::string get_part_name(const std::optional<std::string>& name) {
+        return name.value_or("");
+    }
+
+    // Moves an embedded part into its pool and leaves its name in its place; empty if the part was only named
+    template<typename T, typename DataOrName>
+    std::shared_ptr<const T> intern_embedded_part(InternPool<T>& pool, DataOrName& part) {
+        if (!std::holds_alternative<T>(part)) {
+            return nullptr;
+        }
+        auto& value = std::get<T>(part);
+        std::string name = get_part_name(value.get_name());
+        auto internedValue = pool.intern(std::move(value));
+        part = name;
+        return internedValue;
+    }
+}
+
+std::shared_ptr<const OpenMagnetics::InputsWrapper> intern_inputs(OpenMagnetics::InputsWrapper inputs) {
+    return get_inputs_pool().intern(std::move(inputs));
+}
+
+StoredMas::StoredMas(OpenMagnetics::MagneticWrapper magnetic, std::shared_ptr<const OpenMagnetics::InputsWrapper> inputs, std::vector<OpenMagnetics::Outputs> outputs) : _inputs(std::move(inputs)) {
+    auto& coreFunctionalDescription = magnetic.get_mutable_core().get_mutable_functional_description();
+    auto material = coreFunctionalDescription.get_material();
+    _coreMaterial = intern_embedded_part(get_core_material_pool(), material);
+    coreFunctionalDescription.set_material(material);
+    auto shape = coreFunctionalDescription.get_shape();
+    _coreShape = intern_embedded_part(get_core_shape_pool(), shape);
+    coreFunctionalDescription.set_shape(shape);
+
+    for (auto& winding : magnetic.get_mutable_coil().get_mutable_functional_description()) {
+        auto wire = winding.get_wire();
+        _wires.push_back(intern_embedded_part(get_wire_pool(), wire));
+        winding.set_wire(wire);
+    }
+    _magnetic = std::make_shared<const OpenMagnetics::MagneticWrapper>(std::move(magnetic));
+    if (!outputs.empty()) {
+        _outputs = std::make_shared<const std::vector<OpenMagnetics::Outputs>>(std::move(outputs));
+    }
+}
+
+StoredMas::StoredMas(const OpenMagnetics::MasWrapper& mas) : StoredMas(mas.get_magnetic(), intern_inputs(mas.get_inputs()), mas.get_outputs()) {}
+
+OpenMagnetics::MagneticWrapper StoredMas::get_magnetic() const {
+    OpenMagnetics::MagneticWrapper magnetic = *_magnetic;
+    auto& coreFunctionalDescription = magnetic.get_mutable_core().get_mutable_functional_description();
+    if (_coreMaterial) {
+        coreFunctionalDescription.set_material(*_coreMaterial);
+    }
+    if (_coreShape) {
+        coreFunctionalDescription.set_shape(*_coreShape);
+    }
+    auto& windings = magnetic.get_mutable_coil().get_mutable_functional_description();
+    for (size_t windingIndex = 0; windingIndex < _wires.size(); windingIndex++) {
+        if (_wires[windingIndex]) {
+            windings[windingIndex].set_wire(*_wires[windingIndex]);
+        }
+    }
+    return magnetic;
+}
+
+OpenMagnetics::MasWrapper StoredMas::get_mas() const {
+    OpenMagnetics::MasWrapper mas;
+    mas.set_magnetic(get_magnetic());
+    mas.set_inputs(*_inputs);
+    if (_outputs) {
+        mas.set_outputs(*_outputs);
+    }
+    return mas;
+}
+
+} // namespace MKFNetInternal
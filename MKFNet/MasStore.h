@@ -0,0 +1,118 @@
+#pragma once
+#include "InputsWrapper.h"
+#include "MagneticWrapper.h"
+#include "MasWrapper.h"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <json.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MKFNetInternal {
+
+// Keeps one shared copy of values that serialize to the same JSON, for as long as any holder keeps it.
+// Each entry keeps its canonical JSON, so a lookup serializes only the value being interned
+template<typename T>
+class InternPool {
+    private:
+        struct Entry {
+            std::string canonicalJson;
+            std::weak_ptr<const T> value;
+        };
+
+        std::mutex _mutex;
+        std::unordered_multimap<size_t, Entry> _entries;
+        size_t _sweepThreshold = 64;
+
+        static std::string get_canonical_json(const T& value) {
+            nlohmann::json valueJson;
+            to_json(valueJson, value);
+            return valueJson.dump();
+        }
+
+        // Drops the entries of values no holder keeps any more, once the pool has doubled since the last sweep
+        void sweep_if_grown() {
+            if (_entries.size() < _sweepThreshold) {
+                return;
+            }
+            for (auto entryIterator = _entries.begin(); entryIterator != _entries.end();) {
+                entryIterator = entryIterator->second.value.expired()? _entries.erase(entryIterator) : std::next(entryIterator);
+            }
+            _sweepThreshold = std::max<size_t>(64, 2 * _entries.size());
+        }
+
+    public:
+        std::shared_ptr<const T> intern(T value) {
+            auto canonicalJson = get_canonical_json(value);
+            auto hash = std::hash<std::string>{}(canonicalJson);
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto [entryIterator, lastEntryIterator] = _entries.equal_range(hash);
+            while (entryIterator != lastEntryIterator) {
+                auto pooledValue = entryIterator->second.value.lock();
+                if (!pooledValue) {
+                    entryIterator = _entries.erase(entryIterator);
+                    continue;
+                }
+                if (entryIterator->second.canonicalJson == canonicalJson) {
+                    return pooledValue;
+                }
+                ++entryIterator;
+            }
+            sweep_if_grown();
+            auto internedValue = std::make_shared<const T>(std::move(value));
+            _entries.emplace(hash, Entry{std::move(canonicalJson), internedValue});
+            return internedValue;
+        }
+};
+
+std::shared_ptr<const OpenMagnetics::InputsWrapper> intern_inputs(OpenMagnetics::InputsWrapper inputs);
+
+// A loaded design. Inputs equal to those of other designs are shared with them, and so are an embedded core
+// material, core shape and winding wires, which are held apart while the stored magnetic only names them
+class StoredMas {
+    private:
+        std::shared_ptr<const OpenMagnetics::MagneticWrapper> _magnetic;
+        std::shared_ptr<const OpenMagnetics::CoreMaterial> _coreMaterial;
+        std::shared_ptr<const OpenMagnetics::CoreShape> _coreShape;
+        // One per winding, empty where the winding names a catalog wire
+        std::vector<std::shared_ptr<const OpenMagnetics::Wire>> _wires;
+        std::shared_ptr<const OpenMagnetics::InputsWrapper> _inputs;
+        std::shared_ptr<const std::vector<OpenMagnetics::Outputs>> _outputs;
+
+    public:
+        StoredMas(OpenMagnetics::MagneticWrapper magnetic, std::shared_ptr<const OpenMagnetics::InputsWrapper> inputs, std::vector<OpenMagnetics::Outputs> outputs = {});
+        explicit StoredMas(const OpenMagnetics::MasWrapper& mas);
+
+        // The magnetic as loaded, with its core material, core shape and wires embedded again where it had them
+        OpenMagnetics::MagneticWrapper get_magnetic() const;
+        const OpenMagnetics::InputsWrapper& get_inputs() const {
+            return *_inputs;
+        }
+        OpenMagnetics::MasWrapper get_mas() const;
+
+        // Parts as held, for memory accounting; shared parts compare equal between designs
+        const OpenMagnetics::MagneticWrapper& get_stored_magnetic() const {
+            return *_magnetic;
+        }
+        const std::shared_ptr<const OpenMagnetics::CoreMaterial>& get_core_material() const {
+            return _coreMaterial;
+        }
+        const std::shared_ptr<const OpenMagnetics::CoreShape>& get_core_shape() const {
+            return _coreShape;
+        }
+        const std::vector<std::shared_ptr<const OpenMagnetics::Wire>>& get_wires() const {
+            return _wires;
+        }
+        const std::shared_ptr<const OpenMagnetics::InputsWrapper>& get_shared_inputs() const {
+            return _inputs;
+        }
+        const std::shared_ptr<const std::vector<OpenMagnetics::Outputs>>& get_outputs() const {
+            return _outputs;
+        }
+};
+
+} // namespace MKFNetInternal
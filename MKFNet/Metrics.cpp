@@ -0,0 +1,136 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace MKFNetInternal {
+
+namespace {
+    std::atomic<uint32_t> numberThreadsSeen{0};
+
+    // Timers of one thread: the innermost running stage, the stages already resolved under each parent,
+    // so that only the first timer at a call site takes the registry lock, and the events of a traced call
+    struct ThreadTimingState {
+        StageMetrics* currentStage = nullptr;
+        std::map<std::pair<const StageMetrics*, const char*>, StageMetrics*> resolvedStages;
+        bool tracing = false;
+        std::chrono::steady_clock::time_point traceStart;
+        std::vector<TraceEvent> traceEvents;
+        uint32_t threadIndex = numberThreadsSeen.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    ThreadTimingState& get_thread_timing_state() {
+        thread_local ThreadTimingState state;
+        return state;
+    }
+
+    uint64_t elapsed_nanoseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+}
+
+void StageMetrics::record(uint64_t nanoseconds) {
+    size_t bucketIndex = std::min(size_t(std::bit_width(nanoseconds / 1000)), numberBuckets - 1);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    _buckets[bucketIndex].fetch_add(1, std::memory_order_relaxed);
+    uint64_t maximumNanoseconds = _maximumNanoseconds.load(std::memory_order_relaxed);
+    while (nanoseconds > maximumNanoseconds && !_maximumNanoseconds.compare_exchange_weak(maximumNanoseconds, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+void StageMetrics::reset() {
+    _count.store(0, std::memory_order_relaxed);
+    _totalNanoseconds.store(0, std::memory_order_relaxed);
+    _maximumNanoseconds.store(0, std::memory_order_relaxed);
+    for (auto& bucket : _buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::vector<uint64_t> StageMetrics::get_buckets() const {
+    std::vector<uint64_t> buckets;
+    for (auto& bucket : _buckets) {
+        buckets.push_back(bucket.load(std::memory_order_relaxed));
+    }
+    return buckets;
+}
+
+Metrics& Metrics::get_instance() {
+    static Metrics instance;
+    return instance;
+}
+
+StageMetrics& Metrics::get_stage(const std::string& name) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& stage = _stages[name];
+    if (!stage) {
+        stage = std::make_unique<StageMetrics>(name);
+    }
+    return *stage;
+}
+
+std::vector<const StageMetrics*> Metrics::get_stages() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<const StageMetrics*> stages;
+    for (auto& [name, stage] : _stages) {
+        stages.push_back(stage.get());
+    }
+    return stages;
+}
+
+void Metrics::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& [name, stage] : _stages) {
+        stage->reset();
+    }
+    _lastCallTrace.reset();
+}
+
+void Metrics::set_last_call_trace(std::vector<TraceEvent> events) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _lastCallTrace = std::move(events);
+}
+
+std::optional<std::vector<TraceEvent>> Metrics::get_last_call_trace() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _lastCallTrace;
+}
+
+ScopedTimer::ScopedTimer(const char* name) : _name(name) {
+    auto& state = get_thread_timing_state();
+    _parentStage = state.currentStage;
+    auto& stage = state.resolvedStages[{_parentStage, name}];
+    if (!stage) {
+        stage = &Metrics::get_instance().get_stage(_parentStage? _parentStage->get_name() + "/" + name : std::string(name));
+    }
+    _stage = stage;
+    state.currentStage = _stage;
+    _start = std::chrono::steady_clock::now();
+    if (!_parentStage && Metrics::get_instance().is_call_tracing()) {
+        state.tracing = true;
+        state.traceStart = _start;
+        state.traceEvents.clear();
+    }
+}
+
+void ScopedTimer::stop() {
+    if (!_running) {
+        return;
+    }
+    auto end = std::chrono::steady_clock::now();
+    _running = false;
+    auto& state = get_thread_timing_state();
+    _stage->record(elapsed_nanoseconds(_start, end));
+    state.currentStage = _parentStage;
+    if (state.tracing) {
+        state.traceEvents.push_back({_name, elapsed_nanoseconds(state.traceStart, _start), elapsed_nanoseconds(_start, end), state.threadIndex});
+        if (!_parentStage) {
+            state.tracing = false;
+            Metrics::get_instance().set_last_call_trace(std::move(state.traceEvents));
+            state.traceEvents = {};
+        }
+    }
+}
+
+} // namespace MKFNetInternal
@@ -0,0 +1,128 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace MKFNetInternal {
+
+// Call count, total and maximum duration and a power-of-two histogram of one instrumented stage.
+// Bucket 0 counts durations under 1 us and bucket k those in [2^(k-1), 2^k) us
+class StageMetrics {
+    public:
+        static constexpr size_t numberBuckets = 32;
+
+    private:
+        std::string _name;
+        std::atomic<uint64_t> _count{0};
+        std::atomic<uint64_t> _totalNanoseconds{0};
+        std::atomic<uint64_t> _maximumNanoseconds{0};
+        std::array<std::atomic<uint64_t>, numberBuckets> _buckets{};
+
+    public:
+        explicit StageMetrics(std::string name) : _name(std::move(name)) {}
+
+        const std::string& get_name() const {
+            return _name;
+        }
+
+        void record(uint64_t nanoseconds);
+        void reset();
+
+        uint64_t get_count() const {
+            return _count.load(std::memory_order_relaxed);
+        }
+        uint64_t get_total_nanoseconds() const {
+            return _totalNanoseconds.load(std::memory_order_relaxed);
+        }
+        uint64_t get_maximum_nanoseconds() const {
+            return _maximumNanoseconds.load(std::memory_order_relaxed);
+        }
+        std::vector<uint64_t> get_buckets() const;
+};
+
+// One finished timer of a traced call, relative to the start of the call
+struct TraceEvent {
+    const char* name;
+    uint64_t startNanoseconds;
+    uint64_t durationNanoseconds;
+    uint32_t threadIndex;
+};
+
+// Registry of every stage seen so far. Stages nest by the timers active on the calling thread,
+// so a timer named "parse" running inside "Simulate" is accumulated as "Simulate/parse"
+class Metrics {
+    private:
+        std::mutex _mutex;
+        std::map<std::string, std::unique_ptr<StageMetrics>> _stages;
+        std::atomic<bool> _callTracing{false};
+        std::optional<std::vector<TraceEvent>> _lastCallTrace;
+
+        Metrics() = default;
+
+    public:
+        static Metrics& get_instance();
+
+        Metrics(const Metrics&) = delete;
+        Metrics& operator=(const Metrics&) = delete;
+
+        StageMetrics& get_stage(const std::string& name);
+        std::vector<const StageMetrics*> get_stages();
+        void reset();
+
+        // When enabled, the next outermost call on any thread records its timers as trace events,
+        // replacing the trace of the previous call
+        void set_call_tracing(bool enabled) {
+            _callTracing.store(enabled, std::memory_order_relaxed);
+        }
+        bool is_call_tracing() const {
+            return _callTracing.load(std::memory_order_relaxed);
+        }
+        void set_last_call_trace(std::vector<TraceEvent> events);
+        std::optional<std::vector<TraceEvent>> get_last_call_trace();
+};
+
+// Times its scope, or until stop(), into the stage named after it and the timers enclosing it
+class ScopedTimer {
+    private:
+        StageMetrics* _stage;
+        StageMetrics* _parentStage;
+        const char* _name;
+        std::chrono::steady_clock::time_point _start;
+        bool _running = true;
+
+    public:
+        explicit ScopedTimer(const char* name);
+        ~ScopedTimer() {
+            stop();
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        void stop();
+};
+
+class DisabledTimer {
+    public:
+        void stop() {}
+};
+
+} // namespace MKFNetInternal
+
+#define MKFNET_TIMER_CONCATENATE_(first, second) first##second
+#define MKFNET_TIMER_CONCATENATE(first, second) MKFNET_TIMER_CONCATENATE_(first, second)
+
+#ifndef MKFNET_DISABLE_METRICS
+#define MKFNET_SCOPED_TIMER(name) MKFNetInternal::ScopedTimer MKFNET_TIMER_CONCATENATE(scopedTimer, __LINE__)(name)
+#define MKFNET_NAMED_TIMER(variable, name) MKFNetInternal::ScopedTimer variable(name)
+#else
+#define MKFNET_SCOPED_TIMER(name)
+#define MKFNET_NAMED_TIMER(variable, name) MKFNetInternal::DisabledTimer variable
+#endif
@@ -0,0 +1,122 @@
+#include "SkinEffectTable.h"
+#include "WindingSkinEffectLosses.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+namespace MKFNetInternal {
+
+double calculate_sinusoidal_skin_effect_losses_per_meter(OpenMagnetics::WireWrapper& wire, double frequency, double temperature) {
+    OpenMagnetics::Harmonics harmonics;
+    harmonics.set_amplitudes({1});
+    harmonics.set_frequencies({frequency});
+    OpenMagnetics::SignalDescriptor current;
+    current.set_harmonics(harmonics);
+    return OpenMagnetics::WindingSkinEffectLosses::calculate_skin_effect_losses_per_meter(wire, current, temperature, 1).first;
+}
+
+SkinEffectTable::SkinEffectTable(OpenMagnetics::WireWrapper wire, double temperature) : _wire(wire), _temperature(temperature) {
+    _minimumFrequency = minimumFrequency;
+    _maximumFrequency = maximumFrequency;
+    _directCurrentLossesPerMeter = calculate_sinusoidal_skin_effect_losses_per_meter(wire, 0, temperature);
+
+    std::vector<double> logFrequencies;
+    std::vector<double> logLosses;
+    double logMinimumFrequency = std::log10(_minimumFrequency);
+    double logMaximumFrequency = std::log10(_maximumFrequency);
+    _numberPoints = size_t(std::round((logMaximumFrequency - logMinimumFrequency) * numberPointsPerDecade)) + 1;
+    for (size_t pointIndex = 0; pointIndex < _numberPoints; pointIndex++) {
+        double logFrequency = logMinimumFrequency + (logMaximumFrequency - logMinimumFrequency) * pointIndex / (_numberPoints - 1);
+        double losses = calculate_sinusoidal_skin_effect_losses_per_meter(wire, std::pow(10, logFrequency), temperature);
+        logFrequencies.push_back(logFrequency);
+        logLosses.push_back(std::log(std::max(losses, std::numeric_limits<double>::min())));
+    }
+    _logLossesPerLogFrequency.set_points(logFrequencies, logLosses);
+}
+
+double SkinEffectTable::get_losses_per_meter_per_squared_ampere(double frequency) const {
+    if (frequency <= 0) {
+        return _directCurrentLossesPerMeter;
+    }
+    if (frequency > _maximumFrequency) {
+        auto wire = _wire;
+        return calculate_sinusoidal_skin_effect_losses_per_meter(wire, frequency, _temperature);
+    }
+    // Below the table the skin depth is much larger than any catalog conductor, so losses have flattened out
+    double logFrequency = std::log10(std::max(frequency, _minimumFrequency));
+    return std::exp(_logLossesPerLogFrequency(logFrequency));
+}
+
+SkinEffectTableCache& SkinEffectTableCache::get_instance() {
+    static SkinEffectTableCache instance;
+    return instance;
+}
+
+std::shared_ptr<const SkinEffectTable> SkinEffectTableCache::get_table(OpenMagnetics::WireWrapper& wire, const std::string& wireKey, int temperature) {
+    auto key = std::make_pair(wireKey, temperature);
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        auto tableIterator = _tables.find(key);
+        if (tableIterator != _tables.end()) {
+            tableIterator->second.lastUse = ++_numberUses;
+            return tableIterator->second.table;
+        }
+    }
+    // Built outside the lock so other wires are not blocked; if two threads race, the first table stored wins
+    auto table = std::make_shared<const SkinEffectTable>(wire, temperature);
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    auto tableIterator = _tables.find(key);
+    if (tableIterator != _tables.end()) {
+        return tableIterator->second.table;
+    }
+    if (_tables.size() >= maximumNumberTables) {
+        auto leastRecentlyUsedIterator = std::min_element(_tables.begin(), _tables.end(), [](const auto& first, const auto& second) {
+            return first.second.lastUse < second.second.lastUse;
+        });
+        _tables.erase(leastRecentlyUsedIterator);
+    }
+    return _tables.try_emplace(key, table, ++_numberUses).first->second.table;
+}
+
+std::string SkinEffectTableCache::get_wire_key(const OpenMagnetics::WireWrapper& wire) {
+    json wireJson;
+    to_json(wireJson, wire);
+    return wireJson.dump();
+}
+
+double SkinEffectTableCache::get_losses_per_meter_per_squared_ampere(OpenMagnetics::WireWrapper& wire, double frequency, double temperature) {
+    return get_losses_per_meter_per_squared_ampere(wire, get_wire_key(wire), frequency, temperature);
+}
+
+double SkinEffectTableCache::get_losses_per_meter_per_squared_ampere(OpenMagnetics::WireWrapper& wire, const std::string& wireKey, double frequency, double temperature) {
+    int lowerTemperature = int(std::floor(temperature / temperatureStep)) * temperatureStep;
+    double lowerLosses = get_table(wire, wireKey, lowerTemperature)->get_losses_per_meter_per_squared_ampere(frequency);
+    if (double(lowerTemperature) == temperature) {
+        return lowerLosses;
+    }
+    double upperLosses = get_table(wire, wireKey, lowerTemperature + temperatureStep)->get_losses_per_meter_per_squared_ampere(frequency);
+    double weight = (temperature - lowerTemperature) / temperatureStep;
+    return lowerLosses * (1 - weight) + upperLosses * weight;
+}
+
+void SkinEffectTableCache::clear() {
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    _tables.clear();
+}
+
+size_t SkinEffectTableCache::size() const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _tables.size();
+}
+
+size_t SkinEffectTableCache::get_memory_usage() const {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    size_t memoryUsage = 0;
+    for (auto& [key, cachedTable] : _tables) {
+        memoryUsage += key.first.capacity() + cachedTable.table->get_memory_usage();
+    }
+    return memoryUsage;
+}
+
+} // namespace MKFNetInternal
@@ -0,0 +1,84 @@
+#pragma once
+#include "WireWrapper.h"
+#include "spline.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace MKFNetInternal {
+
+// MKF's skin effect losses per meter of the wire for a sinusoidal current of 1 A peak, the values tables are built from
+double calculate_sinusoidal_skin_effect_losses_per_meter(OpenMagnetics::WireWrapper& wire, double frequency, double temperature);
+
+// Skin effect losses per meter of one wire at one temperature, for a sinusoidal current of 1 A peak,
+// tabulated over frequency and interpolated with a spline in log-log space
+class SkinEffectTable {
+    private:
+        tk::spline _logLossesPerLogFrequency;
+        double _minimumFrequency;
+        double _maximumFrequency;
+        double _directCurrentLossesPerMeter;
+        size_t _numberPoints;
+        OpenMagnetics::WireWrapper _wire;
+        double _temperature;
+
+    public:
+        static constexpr double minimumFrequency = 10;
+        static constexpr double maximumFrequency = 1e8;
+        static constexpr size_t numberPointsPerDecade = 10;
+
+        SkinEffectTable(OpenMagnetics::WireWrapper wire, double temperature);
+
+        double get_losses_per_meter_per_squared_ampere(double frequency) const;
+
+        // The spline keeps its knots and three coefficients per point; the wire copy is not counted
+        size_t get_memory_usage() const {
+            return sizeof(SkinEffectTable) + 5 * _numberPoints * sizeof(double);
+        }
+};
+
+// Tables shared by every caller and thread, built the first time a wire is used near a given temperature.
+// Wires are told apart by their whole description, geometry and material included, never by name alone.
+// Once maximumNumberTables are held, the least recently used table makes room for a new one
+class SkinEffectTableCache {
+    private:
+        struct CachedTable {
+            std::shared_ptr<const SkinEffectTable> table;
+            mutable std::atomic<uint64_t> lastUse;
+
+            CachedTable(std::shared_ptr<const SkinEffectTable> cachedTable, uint64_t use) : table(std::move(cachedTable)), lastUse(use) {}
+        };
+
+        std::map<std::pair<std::string, int>, CachedTable> _tables;
+        std::atomic<uint64_t> _numberUses{0};
+        mutable std::shared_mutex _mutex;
+
+        std::shared_ptr<const SkinEffectTable> get_table(OpenMagnetics::WireWrapper& wire, const std::string& wireKey, int temperature);
+
+    public:
+        // Losses follow the resistivity, which is linear in temperature, so tables every 10 degrees interpolate
+        // linearly to well within the accuracy of the frequency spline
+        static constexpr int temperatureStep = 10;
+        static constexpr size_t maximumNumberTables = 4096;
+
+        static SkinEffectTableCache& get_instance();
+
+        // Canonical JSON of the wire, worth computing once per wire when many frequencies are looked up
+        static std::string get_wire_key(const OpenMagnetics::WireWrapper& wire);
+
+        // Interpolated linearly between the tables of the two closest multiples of temperatureStep
+        double get_losses_per_meter_per_squared_ampere(OpenMagnetics::WireWrapper& wire, const std::string& wireKey, double frequency, double temperature);
+        double get_losses_per_meter_per_squared_ampere(OpenMagnetics::WireWrapper& wire, double frequency, double temperature);
+
+        void clear();
+        size_t size() const;
+        // Tables and their keys, which hold the canonical JSON of each wire
+        size_t get_memory_usage() const;
+};
+
+} // namespace MKFNetInternal
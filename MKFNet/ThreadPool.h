@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace MKFNetInternal {
+
+class ThreadPool {
+    private:
+        std::vector<std::thread> _workers;
+        std::queue<std::function<void()>> _tasks;
+        std::mutex _mutex;
+        std::condition_variable _taskAvailable;
+        bool _stopping = false;
+
+        static inline thread_local bool _isWorkerThread = false;
+
+        void run_worker() {
+            mark_worker_thread();
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _taskAvailable.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+                    if (_stopping && _tasks.empty()) {
+                        return;
+                    }
+                    task = std::move(_tasks.front());
+                    _tasks.pop();
+                }
+                task();
+            }
+        }
+
+    public:
+        explicit ThreadPool(size_t numberThreads = 0) {
+            if (numberThreads == 0) {
+                numberThreads = std::max(1u, std::thread::hardware_concurrency());
+            }
+            for (size_t threadIndex = 0; threadIndex < numberThreads; threadIndex++) {
+                _workers.emplace_back([this] { run_worker(); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+            }
+            _taskAvailable.notify_all();
+            for (auto& worker : _workers) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t get_number_threads() const {
+            return _workers.size();
+        }
+
+        // True on threads owned by a pool or a job system, where nested work should stay on the thread
+        // instead of fanning out again
+        static bool is_worker_thread() {
+            return _isWorkerThread;
+        }
+        static void mark_worker_thread() {
+            _isWorkerThread = true;
+        }
+
+        template<typename Task>
+        std::future<std::invoke_result_t<Task>> submit(Task&& task) {
+            using Result = std::invoke_result_t<Task>;
+            auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+            auto future = packagedTask->get_future();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _tasks.emplace([packagedTask] { (*packagedTask)(); });
+            }
+            _taskAvailable.notify_one();
+            return future;
+        }
+};
+
+} // namespace MKFNetInternal
@@ -0,0 +1,47 @@
+#include "TurnTable.h"
+#include <map>
+#include <stdexcept>
+
+namespace MKFNetInternal {
+
+TurnTable build_turn_table(OpenMagnetics::CoilWrapper& coil) {
+    if (!coil.get_turns_description()) {
+        throw std::invalid_argument("Coil is missing its turns description");
+    }
+    auto turns = coil.get_turns_description().value();
+    auto& functionalDescription = coil.get_functional_description();
+
+    TurnTable turnTable;
+    std::map<std::string, uint32_t> windingIndexByName;
+    for (size_t windingIndex = 0; windingIndex < functionalDescription.size(); windingIndex++) {
+        windingIndexByName[functionalDescription[windingIndex].get_name()] = windingIndex;
+        turnTable.numberParallelsPerWinding.push_back(functionalDescription[windingIndex].get_number_parallels());
+    }
+
+    turnTable.x.reserve(turns.size());
+    turnTable.y.reserve(turns.size());
+    turnTable.width.reserve(turns.size());
+    turnTable.height.reserve(turns.size());
+    turnTable.length.reserve(turns.size());
+    turnTable.windingIndex.reserve(turns.size());
+    turnTable.parallelIndex.reserve(turns.size());
+    for (auto& turn : turns) {
+        auto& coordinates = turn.get_coordinates();
+        turnTable.x.push_back(coordinates[0]);
+        turnTable.y.push_back(coordinates.size() > 1? coordinates[1] : 0);
+        if (turn.get_dimensions()) {
+            turnTable.width.push_back(turn.get_dimensions().value()[0]);
+            turnTable.height.push_back(turn.get_dimensions().value()[1]);
+        }
+        else {
+            turnTable.width.push_back(0);
+            turnTable.height.push_back(0);
+        }
+        turnTable.length.push_back(turn.get_length());
+        turnTable.windingIndex.push_back(windingIndexByName.at(turn.get_winding()));
+        turnTable.parallelIndex.push_back(turn.get_parallel());
+    }
+    return turnTable;
+}
+
+} // namespace MKFNetInternal
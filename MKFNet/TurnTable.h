@@ -0,0 +1,32 @@
+#pragma once
+#include "CoilWrapper.h"
+#include <cstdint>
+#include <vector>
+
+namespace MKFNetInternal {
+
+// Packed copy of a coil turns description, one array per turn property, so that kernels
+// walking every turn read contiguous memory instead of the optional-heavy MAS Turn objects
+struct TurnTable {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> width;
+    std::vector<double> height;
+    std::vector<double> length;
+    std::vector<uint32_t> windingIndex;
+    std::vector<uint32_t> parallelIndex;
+    std::vector<uint32_t> numberParallelsPerWinding;
+
+    size_t size() const {
+        return x.size();
+    }
+
+    size_t get_memory_usage() const {
+        return sizeof(TurnTable) + (x.capacity() + y.capacity() + width.capacity() + height.capacity() + length.capacity()) * sizeof(double) +
+               (windingIndex.capacity() + parallelIndex.capacity() + numberParallelsPerWinding.capacity()) * sizeof(uint32_t);
+    }
+};
+
+TurnTable build_turn_table(OpenMagnetics::CoilWrapper& coil);
+
+} // namespace MKFNetInternal
@@ -0,0 +1,33 @@
+#include "WireGeometry.h"
+#include <cmath>
+#include <numbers>
+
+namespace MKFNetInternal {
+
+double get_wire_conducting_area(OpenMagnetics::WireWrapper& wire) {
+    switch (wire.get_type()) {
+        case OpenMagnetics::WireType::ROUND: {
+            double conductingDiameter = OpenMagnetics::resolve_dimensional_values(wire.get_conducting_diameter().value());
+            return std::numbers::pi * conductingDiameter * conductingDiameter / 4;
+        }
+        case OpenMagnetics::WireType::LITZ: {
+            auto strand = wire.resolve_strand();
+            double strandConductingDiameter = OpenMagnetics::resolve_dimensional_values(strand.get_conducting_diameter());
+            return std::numbers::pi * strandConductingDiameter * strandConductingDiameter / 4 * wire.get_number_conductors().value();
+        }
+        default:
+            return OpenMagnetics::resolve_dimensional_values(wire.get_conducting_width().value()) * OpenMagnetics::resolve_dimensional_values(wire.get_conducting_height().value());
+    }
+}
+
+std::pair<double, double> get_wire_outer_dimensions(OpenMagnetics::WireWrapper& wire) {
+    if (wire.get_type() == OpenMagnetics::WireType::ROUND || wire.get_type() == OpenMagnetics::WireType::LITZ) {
+        double outerDiameter = wire.get_outer_diameter()? OpenMagnetics::resolve_dimensional_values(wire.get_outer_diameter().value()) : std::sqrt(get_wire_conducting_area(wire) * 4 / std::numbers::pi);
+        return {outerDiameter, outerDiameter};
+    }
+    double outerWidth = OpenMagnetics::resolve_dimensional_values(wire.get_outer_width()? wire.get_outer_width().value() : wire.get_conducting_width().value());
+    double outerHeight = OpenMagnetics::resolve_dimensional_values(wire.get_outer_height()? wire.get_outer_height().value() : wire.get_conducting_height().value());
+    return {outerWidth, outerHeight};
+}
+
+} // namespace MKFNetInternal
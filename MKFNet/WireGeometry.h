@@ -0,0 +1,13 @@
+#pragma once
+#include "WireWrapper.h"
+#include <utility>
+
+namespace MKFNetInternal {
+
+// Copper cross section of one wire, every strand of a litz wire included
+double get_wire_conducting_area(OpenMagnetics::WireWrapper& wire);
+
+// Outer width and height of one wire, the diameter twice for round and litz wires
+std::pair<double, double> get_wire_outer_dimensions(OpenMagnetics::WireWrapper& wire);
+
+} // namespace MKFNetInternal
@@ -0,0 +1,70 @@
+#include "FieldKernel.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <magic_enum.hpp>
+#include <optional>
+#include <random>
+#include <string>
+
+// Litz-like winding filling a 20 mm x 10 mm window, the case where per-turn field kernels dominate
+MKFNetInternal::FieldSources create_high_turn_count_winding(size_t numberTurns) {
+    const double windowWidth = 0.010;
+    const double windowHeight = 0.020;
+    const double turnRadius = 0.0001;
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> widthDistribution(0.0, windowWidth);
+    std::uniform_real_distribution<double> heightDistribution(-windowHeight / 2, windowHeight / 2);
+    std::uniform_real_distribution<double> currentDistribution(-1.0, 1.0);
+
+    MKFNetInternal::FieldSources sources;
+    for (size_t turnIndex = 0; turnIndex < numberTurns; turnIndex++) {
+        sources.push_back(widthDistribution(generator), heightDistribution(generator), turnRadius, currentDistribution(generator));
+    }
+    return sources;
+}
+
+// Field is evaluated at every turn centre, as for proximity losses, with one mirror in each direction
+static void BM_FieldKernel(benchmark::State& state, MKFNetInternal::FieldKernelInstructionSet instructionSet, size_t numberThreads) {
+    const double tolerance = 1e-9;
+    if (instructionSet > MKFNetInternal::get_field_kernel_instruction_set()) {
+        state.SkipWithError(("CPU does not support " + std::string(magic_enum::enum_name(instructionSet))).c_str());
+        return;
+    }
+
+    auto sources = create_high_turn_count_winding(state.range(0));
+    auto mirroredSources = MKFNetInternal::add_mirrored_sources(sources, 0, 0.010, -0.010, 0.010, 1);
+    size_t numberPoints = sources.size();
+    std::vector<double> fieldX(numberPoints), fieldY(numberPoints);
+    std::optional<MKFNetInternal::ThreadPool> pool;
+    if (numberThreads != 1) {
+        pool.emplace(numberThreads);
+    }
+    for (auto _ : state) {
+        MKFNetInternal::calculate_magnetic_field_strength(mirroredSources, sources.x.data(), sources.y.data(), numberPoints, fieldX.data(), fieldY.data(), instructionSet, pool? &pool.value() : nullptr);
+        benchmark::DoNotOptimize(fieldX.data());
+        benchmark::DoNotOptimize(fieldY.data());
+    }
+
+    std::vector<double> referenceFieldX(numberPoints), referenceFieldY(numberPoints);
+    MKFNetInternal::calculate_magnetic_field_strength_scalar(mirroredSources, sources.x.data(), sources.y.data(), numberPoints, referenceFieldX.data(), referenceFieldY.data());
+    double maximumRelativeError = 0;
+    for (size_t pointIndex = 0; pointIndex < numberPoints; pointIndex++) {
+        double reference = std::hypot(referenceFieldX[pointIndex], referenceFieldY[pointIndex]);
+        double error = std::hypot(fieldX[pointIndex] - referenceFieldX[pointIndex], fieldY[pointIndex] - referenceFieldY[pointIndex]);
+        maximumRelativeError = std::max(maximumRelativeError, error / std::max(reference, 1e-12));
+    }
+    state.counters["maximumRelativeError"] = maximumRelativeError;
+    state.SetItemsProcessed(state.iterations() * numberPoints * mirroredSources.size());
+    if (maximumRelativeError > tolerance) {
+        state.SkipWithError("Field differs from the scalar kernel");
+    }
+}
+BENCHMARK_CAPTURE(BM_FieldKernel, scalar_1_thread, MKFNetInternal::FieldKernelInstructionSet::SCALAR, 1)->ArgName("turns")->Arg(300)->Arg(3000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_FieldKernel, avx2_1_thread, MKFNetInternal::FieldKernelInstructionSet::AVX2, 1)->ArgName("turns")->Arg(300)->Arg(3000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_FieldKernel, avx2_all_threads, MKFNetInternal::FieldKernelInstructionSet::AVX2, 0)->ArgName("turns")->Arg(300)->Arg(3000)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_FieldKernel, avx512_1_thread, MKFNetInternal::FieldKernelInstructionSet::AVX512, 1)->ArgName("turns")->Arg(300)->Arg(3000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_FieldKernel, avx512_all_threads, MKFNetInternal::FieldKernelInstructionSet::AVX512, 0)->ArgName("turns")->Arg(300)->Arg(3000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
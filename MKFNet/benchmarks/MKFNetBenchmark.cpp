@@ -0,0 +1,425 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <json.hpp>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "CoreMaterialCache.h"
+#include "MKFNet.h"
+#include "SkinEffectTable.h"
+#include "MagneticField.h"
+#include "MagneticWrapper.h"
+#include "Settings.h"
+
+using json = nlohmann::json;
+
+// Flyback with three windings from MKFNetTest, stored in benchmarks/fixtures so every run sees the same design
+const std::string& read_fixture(const std::string& name) {
+    static std::map<std::string, std::string> fixtures;
+    auto fixtureIterator = fixtures.find(name);
+    if (fixtureIterator == fixtures.end()) {
+        std::ifstream fixtureFile(std::filesystem::path{MKFNET_BENCHMARK_FIXTURES_DIRECTORY} / name);
+        if (!fixtureFile) {
+            throw std::runtime_error("Missing benchmark fixture " + name);
+        }
+        std::stringstream buffer;
+        buffer << fixtureFile.rdbuf();
+        fixtureIterator = fixtures.emplace(name, buffer.str()).first;
+    }
+    return fixtureIterator->second;
+}
+
+std::string get_operating_point() {
+    return json::parse(read_fixture("inputs.json"))["operatingPoints"][0].dump();
+}
+
+bool check_result(benchmark::State& state, const std::string& result) {
+    if (result.starts_with("Exception: ")) {
+        state.SkipWithError(result.c_str());
+        return false;
+    }
+    return true;
+}
+
+static void BM_ReadDatabases(benchmark::State& state) {
+    MKFNet mkfNet;
+    for (auto _ : state) {
+        auto result = mkfNet.ReadDatabases(MKFNET_BENCHMARK_MAS_DATA_DIRECTORY, true);
+        if (result != "0") {
+            state.SkipWithError(result.c_str());
+            break;
+        }
+    }
+}
+BENCHMARK(BM_ReadDatabases)->Unit(benchmark::kMillisecond);
+
+// Same catalogs as BM_ReadDatabases, read from a snapshot written once before timing
+static void BM_ReadCatalogSnapshot(benchmark::State& state) {
+    MKFNet mkfNet;
+    auto snapshotPath = (std::filesystem::temp_directory_path() / "MKFNetBenchmarkCatalogs.snapshot").string();
+    auto writeResult = mkfNet.WriteCatalogSnapshot(MKFNET_BENCHMARK_MAS_DATA_DIRECTORY, snapshotPath);
+    if (writeResult != "0") {
+        state.SkipWithError(writeResult.c_str());
+        return;
+    }
+    for (auto _ : state) {
+        auto result = mkfNet.ReadCatalogSnapshot(snapshotPath, true);
+        if (result != "0") {
+            state.SkipWithError(result.c_str());
+            break;
+        }
+    }
+    std::filesystem::remove(snapshotPath);
+}
+BENCHMARK(BM_ReadCatalogSnapshot)->Unit(benchmark::kMillisecond);
+
+static void BM_LoadMagnetics(benchmark::State& state) {
+    MKFNet mkfNet;
+    bool expand = state.range(1);
+    json keys = json::array();
+    json magnetics = json::array();
+    auto magnetic = json::parse(read_fixture("magnetic.json"));
+    for (int64_t magneticIndex = 0; magneticIndex < state.range(0); magneticIndex++) {
+        keys.push_back("benchmark_" + std::to_string(magneticIndex));
+        magnetics.push_back(magnetic);
+    }
+    auto keysString = keys.dump();
+    auto magneticsString = magnetics.dump();
+    for (auto _ : state) {
+        auto result = mkfNet.LoadMagnetics(keysString, magneticsString, read_fixture("inputs.json"), expand);
+        if (result.find_first_not_of("0123456789") != std::string::npos) {
+            state.SkipWithError(result.c_str());
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+// Loading without expansion isolates parsing and storage, so the difference between both is expandMagnetic
+BENCHMARK(BM_LoadMagnetics)->ArgNames({"magnetics", "expand"})->ArgsProduct({{1, 16}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+static void BM_CalculateCoreLosses(benchmark::State& state) {
+    MKFNet mkfNet;
+    for (auto _ : state) {
+        if (!check_result(state, mkfNet.CalculateCoreLosses(read_fixture("magnetic.json"), read_fixture("inputs.json"), read_fixture("models.json")))) {
+            break;
+        }
+    }
+}
+BENCHMARK(BM_CalculateCoreLosses)->Unit(benchmark::kMillisecond);
+
+// Core losses of the fixture's material read from its surface at points between the grid nodes, temperatures
+// included, checked against the default model evaluated directly; the largest relative difference is reported
+static void BM_CalculateCoreLossesDensity(benchmark::State& state) {
+    const double tolerance = 5e-2;
+    const std::vector<double> magneticFluxDensityPeaks{0.0137, 0.061, 0.183};
+    const std::vector<double> frequencies{23.7e3, 147e3, 613e3};
+    const std::vector<double> temperatures{37, 62, 88, 113};
+    std::string materialName = json::parse(read_fixture("magnetic.json"))["core"]["functionalDescription"]["material"]["name"];
+    MKFNet mkfNet;
+    for (auto _ : state) {
+        for (auto magneticFluxDensityPeak : magneticFluxDensityPeaks) {
+            for (auto frequency : frequencies) {
+                for (auto temperature : temperatures) {
+                    benchmark::DoNotOptimize(mkfNet.CalculateCoreLossesDensity(materialName, "", magneticFluxDensityPeak, frequency, temperature));
+                }
+            }
+        }
+    }
+
+    auto coreMaterial = OpenMagnetics::find_core_material_by_name(materialName);
+    auto coreLossesModel = OpenMagnetics::CoreLossesModel::factory(OpenMagnetics::Defaults().coreLossesModelDefault);
+    double maximumRelativeDifference = 0;
+    for (auto magneticFluxDensityPeak : magneticFluxDensityPeaks) {
+        for (auto frequency : frequencies) {
+            auto excitation = MKFNetInternal::create_magnetic_flux_density_excitation(OpenMagnetics::WaveformLabel::SINUSOIDAL, magneticFluxDensityPeak, frequency);
+            for (auto temperature : temperatures) {
+                double volumetricLosses = mkfNet.CalculateCoreLossesDensity(materialName, "", magneticFluxDensityPeak, frequency, temperature);
+                double referenceVolumetricLosses = coreLossesModel->get_core_volumetric_losses(coreMaterial, excitation, temperature);
+                if (referenceVolumetricLosses > 0) {
+                    maximumRelativeDifference = std::max(maximumRelativeDifference, std::abs(volumetricLosses - referenceVolumetricLosses) / referenceVolumetricLosses);
+                }
+            }
+        }
+    }
+    state.counters["maximumRelativeDifference"] = maximumRelativeDifference;
+    if (maximumRelativeDifference > tolerance) {
+        state.SkipWithError("Core losses surface differs from the core losses model");
+    }
+}
+BENCHMARK(BM_CalculateCoreLossesDensity)->Unit(benchmark::kMicrosecond);
+
+static void BM_CalculateWindingLosses(benchmark::State& state) {
+    MKFNet mkfNet;
+    auto operatingPoint = get_operating_point();
+    for (auto _ : state) {
+        if (!check_result(state, mkfNet.CalculateWindingLosses(read_fixture("magnetic.json"), operatingPoint, 25, 0.05))) {
+            break;
+        }
+    }
+}
+BENCHMARK(BM_CalculateWindingLosses)->Unit(benchmark::kMillisecond);
+
+static void BM_CalculateMagneticFieldStrengthField(benchmark::State& state) {
+    MKFNet mkfNet;
+    auto operatingPoint = get_operating_point();
+    for (auto _ : state) {
+        if (!check_result(state, mkfNet.CalculateMagneticFieldStrengthField(operatingPoint, read_fixture("magnetic.json")))) {
+            break;
+        }
+    }
+}
+BENCHMARK(BM_CalculateMagneticFieldStrengthField)->Unit(benchmark::kMillisecond);
+
+static void BM_CalculateWindingWindowMagneticStrengthField(benchmark::State& state) {
+    MKFNet mkfNet;
+    auto operatingPoint = get_operating_point();
+    for (auto _ : state) {
+        if (!check_result(state, mkfNet.CalculateWindingWindowMagneticStrengthField(operatingPoint, read_fixture("magnetic.json"), 0, 0))) {
+            break;
+        }
+    }
+}
+BENCHMARK(BM_CalculateWindingWindowMagneticStrengthField)->Unit(benchmark::kMillisecond);
+
+// With gap fringing left out, CalculateMagneticFieldStrengthField takes the kernel for the fixture's round and litz
+// turns; it is checked against MKF's own MagneticField at every turn, harmonic by harmonic. Each field component may
+// differ by at most tolerance times the largest field of its harmonic; the largest difference found is reported
+static void BM_CalculateMagneticFieldStrengthFieldKernel(benchmark::State& state) {
+    const double tolerance = 1e-2;
+    MKFNet mkfNet;
+    auto operatingPoint = get_operating_point();
+    auto settings = OpenMagnetics::Settings::GetInstance();
+    bool includeFringing = settings->get_magnetic_field_include_fringing();
+    settings->set_magnetic_field_include_fringing(false);
+    std::string result;
+    for (auto _ : state) {
+        result = mkfNet.CalculateMagneticFieldStrengthField(operatingPoint, read_fixture("magnetic.json"));
+        if (!check_result(state, result)) {
+            settings->set_magnetic_field_include_fringing(includeFringing);
+            return;
+        }
+    }
+
+    OpenMagnetics::MagneticWrapper magnetic(json::parse(read_fixture("magnetic.json")));
+    OpenMagnetics::MagneticField magneticField;
+    auto referenceOutput = magneticField.calculate_magnetic_field_strength_field(OpenMagnetics::OperatingPoint(json::parse(operatingPoint)), magnetic);
+    settings->set_magnetic_field_include_fringing(includeFringing);
+    json reference;
+    to_json(reference, referenceOutput);
+
+    std::map<double, std::map<int64_t, std::pair<double, double>>> referenceFieldPerFrequency;
+    for (auto& field : reference["fieldPerFrequency"]) {
+        for (auto& fieldPoint : field["data"]) {
+            if (fieldPoint.contains("turnIndex")) {
+                referenceFieldPerFrequency[field["frequency"]][fieldPoint["turnIndex"]] = {fieldPoint["real"].get<double>(), fieldPoint["imaginary"].get<double>()};
+            }
+        }
+    }
+    double maximumRelativeDifference = 0;
+    size_t numberComparedPoints = 0;
+    for (auto& field : json::parse(result)["fieldPerFrequency"]) {
+        auto referenceFieldIterator = referenceFieldPerFrequency.find(field["frequency"]);
+        if (referenceFieldIterator == referenceFieldPerFrequency.end()) {
+            continue;
+        }
+        double maximumReferenceField = 0;
+        for (auto& [turnIndex, referenceField] : referenceFieldIterator->second) {
+            maximumReferenceField = std::max(maximumReferenceField, std::hypot(referenceField.first, referenceField.second));
+        }
+        if (maximumReferenceField == 0) {
+            continue;
+        }
+        for (auto& fieldPoint : field["data"]) {
+            auto referencePointIterator = referenceFieldIterator->second.find(fieldPoint["turnIndex"]);
+            if (referencePointIterator == referenceFieldIterator->second.end()) {
+                continue;
+            }
+            double difference = std::max(std::abs(fieldPoint["real"].get<double>() - referencePointIterator->second.first),
+                                         std::abs(fieldPoint["imaginary"].get<double>() - referencePointIterator->second.second));
+            maximumRelativeDifference = std::max(maximumRelativeDifference, difference / maximumReferenceField);
+            numberComparedPoints++;
+        }
+    }
+    state.counters["maximumRelativeDifference"] = maximumRelativeDifference;
+    state.counters["comparedPoints"] = numberComparedPoints;
+    if (numberComparedPoints == 0) {
+        state.SkipWithError("No turn of the kernel field matched MKF's magnetic field");
+    }
+    else if (maximumRelativeDifference > tolerance) {
+        state.SkipWithError("Field differs from MKF's magnetic field");
+    }
+}
+BENCHMARK(BM_CalculateMagneticFieldStrengthFieldKernel)->Unit(benchmark::kMillisecond);
+
+// Skin effect losses of the fixture's first wire read from the shared tables at frequencies and temperatures off
+// their grids, checked against MKF's model evaluated directly; the largest relative difference is reported
+static void BM_SkinEffectTable(benchmark::State& state) {
+    const double tolerance = 1e-2;
+    const std::vector<double> temperatures{27.3, 63.7, 101.9};
+    std::vector<double> frequencies;
+    for (double logFrequency = 1.05; logFrequency < 7; logFrequency += 0.5) {
+        frequencies.push_back(std::pow(10, logFrequency));
+    }
+    OpenMagnetics::MagneticWrapper magnetic(json::parse(read_fixture("magnetic.json")));
+    auto coil = magnetic.get_coil();
+    auto wire = coil.resolve_wire(0);
+    auto& skinEffectTables = MKFNetInternal::SkinEffectTableCache::get_instance();
+    skinEffectTables.clear();
+    auto wireKey = MKFNetInternal::SkinEffectTableCache::get_wire_key(wire);
+    for (auto _ : state) {
+        for (auto temperature : temperatures) {
+            for (auto frequency : frequencies) {
+                benchmark::DoNotOptimize(skinEffectTables.get_losses_per_meter_per_squared_ampere(wire, wireKey, frequency, temperature));
+            }
+        }
+    }
+
+    double maximumRelativeDifference = 0;
+    for (auto temperature : temperatures) {
+        for (auto frequency : frequencies) {
+            double losses = skinEffectTables.get_losses_per_meter_per_squared_ampere(wire, wireKey, frequency, temperature);
+            double referenceLosses = MKFNetInternal::calculate_sinusoidal_skin_effect_losses_per_meter(wire, frequency, temperature);
+            if (referenceLosses > 0) {
+                maximumRelativeDifference = std::max(maximumRelativeDifference, std::abs(losses - referenceLosses) / referenceLosses);
+            }
+        }
+    }
+    state.counters["maximumRelativeDifference"] = maximumRelativeDifference;
+    state.counters["tables"] = skinEffectTables.size();
+    if (maximumRelativeDifference > tolerance) {
+        state.SkipWithError("Skin effect tables differ from MKF's skin effect losses");
+    }
+}
+BENCHMARK(BM_SkinEffectTable)->Unit(benchmark::kMicrosecond);
+
+static void BM_Simulate(benchmark::State& state) {
+    MKFNet mkfNet;
+    for (auto _ : state) {
+        if (!check_result(state, mkfNet.Simulate(read_fixture("inputs.json"), read_fixture("magnetic.json"), read_fixture("models.json")))) {
+            break;
+        }
+    }
+}
+BENCHMARK(BM_Simulate)->Unit(benchmark::kMillisecond);
+
+// Each patch must recompute exactly the sub-results its path reaches, so a wrong entry in the invalidation
+// mapping fails the run instead of only changing its time
+static void BM_SimulateDelta(benchmark::State& state, std::string patchedPath, std::vector<std::string> expectedRecomputed) {
+    MKFNet mkfNet;
+    auto magnetic = json::parse(read_fixture("magnetic.json"));
+    auto loadResult = mkfNet.LoadMagnetic("benchmark", magnetic.dump(), read_fixture("inputs.json"), true);
+    if (loadResult.find_first_not_of("0123456789") != std::string::npos) {
+        state.SkipWithError(loadResult.c_str());
+        return;
+    }
+    json document;
+    document["magnetic"] = magnetic;
+    document["inputs"] = json::parse(read_fixture("inputs.json"));
+    json patchOperation;
+    patchOperation["op"] = "add";
+    patchOperation["path"] = patchedPath;
+    // Numbers are changed and names set, anything else is written back as it was, which still counts as an edit of that path
+    auto patchedPointer = json::json_pointer(patchedPath);
+    if (!document.contains(patchedPointer)) {
+        patchOperation["value"] = "benchmark";
+    }
+    else if (document[patchedPointer].is_number()) {
+        patchOperation["value"] = document[patchedPointer].get<double>() + 10;
+    }
+    else {
+        patchOperation["value"] = document[patchedPointer];
+    }
+    auto patchString = json::array({patchOperation}).dump();
+    auto& modelsString = read_fixture("models.json");
+
+    std::string result;
+    for (auto _ : state) {
+        result = mkfNet.SimulateDelta("benchmark", patchString, modelsString);
+        if (!check_result(state, result)) {
+            return;
+        }
+    }
+    auto recomputed = json::parse(result)["recomputed"].get<std::vector<std::string>>();
+    std::sort(expectedRecomputed.begin(), expectedRecomputed.end());
+    if (recomputed != expectedRecomputed) {
+        state.SkipWithError(("Patching " + patchedPath + " recomputed " + json(recomputed).dump()).c_str());
+    }
+}
+BENCHMARK_CAPTURE(BM_SimulateDelta, material, std::string("/magnetic/core/functionalDescription/material"), std::vector<std::string>{"magnetizingInductance", "coreLosses"})->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SimulateDelta, gapping, std::string("/magnetic/core/functionalDescription/gapping"), std::vector<std::string>{"magnetizingInductance", "coreLosses", "windingLosses"})->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SimulateDelta, numberTurns, std::string("/magnetic/coil/functionalDescription/0/numberTurns"), std::vector<std::string>{"magnetizingInductance", "coreLosses", "windingLosses"})->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SimulateDelta, numberParallels, std::string("/magnetic/coil/functionalDescription/1/numberParallels"), std::vector<std::string>{"windingLosses"})->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SimulateDelta, wire, std::string("/magnetic/coil/functionalDescription/0/wire"), std::vector<std::string>{"windingLosses"})->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SimulateDelta, ambientTemperature, std::string("/inputs/operatingPoints/0/conditions/ambientTemperature"), std::vector<std::string>{"magnetizingInductance", "coreLosses", "windingLosses"})->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SimulateDelta, unmappedPath, std::string("/magnetic/core/name"), std::vector<std::string>{"magnetizingInductance", "coreLosses", "windingLosses"})->Unit(benchmark::kMillisecond);
+
+// Advisers take seconds per run, so a few fixed iterations keep the suite usable
+static void BM_CalculateAdvisedCores(benchmark::State& state) {
+    MKFNet mkfNet;
+    for (auto _ : state) {
+        if (!check_result(state, mkfNet.CalculateAdvisedCores(read_fixture("inputs.json"), read_fixture("weights.json"), state.range(0), true))) {
+            break;
+        }
+    }
+}
+BENCHMARK(BM_CalculateAdvisedCores)->ArgName("results")->Arg(5)->Iterations(3)->Unit(benchmark::kMillisecond);
+
+static void BM_CalculateAdvisedMagnetics(benchmark::State& state) {
+    MKFNet mkfNet;
+    for (auto _ : state) {
+        if (!check_result(state, mkfNet.CalculateAdvisedMagnetics(read_fixture("inputs.json"), state.range(0)))) {
+            break;
+        }
+    }
+}
+BENCHMARK(BM_CalculateAdvisedMagnetics)->ArgName("results")->Arg(1)->Iterations(3)->Unit(benchmark::kMillisecond);
+
+static void BM_CalculateHarmonics(benchmark::State& state) {
+    MKFNet mkfNet;
+    auto excitation = json::parse(get_operating_point())["excitationsPerWinding"][0];
+    auto waveformString = excitation["current"]["waveform"].dump();
+    double frequency = excitation["frequency"];
+    for (auto _ : state) {
+        if (!check_result(state, mkfNet.CalculateHarmonics(waveformString, frequency))) {
+            break;
+        }
+    }
+}
+BENCHMARK(BM_CalculateHarmonics)->Unit(benchmark::kMicrosecond);
+
+static void BM_PlotToString(benchmark::State& state, std::string plotKind) {
+    MKFNet mkfNet;
+    auto operatingPoint = plotKind == "field"? get_operating_point() : "";
+    for (auto _ : state) {
+        auto svg = mkfNet.PlotToString(read_fixture("magnetic.json"), plotKind, operatingPoint);
+        if (!check_result(state, svg)) {
+            break;
+        }
+        benchmark::DoNotOptimize(svg);
+    }
+}
+BENCHMARK_CAPTURE(BM_PlotToString, core, std::string("core"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PlotToString, sections, std::string("sections"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PlotToString, layers, std::string("layers"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PlotToString, turns, std::string("turns"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PlotToString, field, std::string("field"))->Unit(benchmark::kMillisecond);
+
+static void BM_PlotField(benchmark::State& state) {
+    MKFNet mkfNet;
+    auto operatingPoint = get_operating_point();
+    auto outFile = (std::filesystem::temp_directory_path() / "MKFNetBenchmarkField.svg").string();
+    for (auto _ : state) {
+        if (!mkfNet.PlotField(read_fixture("magnetic.json"), operatingPoint, outFile)) {
+            state.SkipWithError("PlotField failed");
+            break;
+        }
+    }
+    std::filesystem::remove(outFile);
+}
+BENCHMARK(BM_PlotField)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
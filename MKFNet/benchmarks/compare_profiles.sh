@@ -0,0 +1,47 @@
+#!/usr/bin/env bash
+# Builds MKFNetBenchmark as Release, LTO and PGO side by side, runs it on each and compares LTO and PGO against Release
+# with the script shipped by Google Benchmark. Usage: compare_profiles.sh <output directory> [repetitions]
+set -euo pipefail
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <output directory> [repetitions]" >&2
+    exit 1
+fi
+source_directory=$(cd "$(dirname "$0")/.." && pwd)
+mkdir -p "$1"
+output_directory=$(cd "$1" && pwd)
+repetitions=${2:-5}
+
+build() {
+    local profile=$1
+    shift
+    cmake -S "$source_directory" -B "$output_directory/$profile" -G Ninja -DCMAKE_BUILD_TYPE=Release -DBUILD_BENCHMARKS=ON "$@"
+    cmake --build "$output_directory/$profile" --target MKFNetBenchmark
+}
+
+run() {
+    local profile=$1
+    "$output_directory/$profile/MKFNetBenchmark" --benchmark_repetitions="$repetitions" --benchmark_report_aggregates_only=true \
+        --benchmark_out="$output_directory/$profile.json" --benchmark_out_format=json
+}
+
+build release
+run release
+
+build lto -DMKFNET_ENABLE_LTO=ON
+run lto
+
+# Trained by the whole suite, as described in BUILD.md; Clang writes raw profiles that have to be merged first
+pgo_directory="$output_directory/pgo/profiles"
+build pgo -DMKFNET_PGO=GENERATE -DMKFNET_PGO_DIRECTORY="$pgo_directory"
+cmake --build "$output_directory/pgo" --target run_benchmarks
+if compgen -G "$pgo_directory/*.profraw" > /dev/null; then
+    llvm-profdata merge -output="$pgo_directory/default.profdata" "$pgo_directory"/*.profraw
+fi
+build pgo -DMKFNET_PGO=USE
+run pgo
+
+compare="$output_directory/release/_deps/googlebenchmark-src/tools/compare.py"
+for profile in lto pgo; do
+    python3 "$compare" benchmarks "$output_directory/release.json" "$output_directory/$profile.json" | tee "$output_directory/${profile}_against_release.txt"
+done
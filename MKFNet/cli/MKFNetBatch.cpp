@@ -0,0 +1,175 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "MKFNet.h"
+#include "MKFNetDispatcher.h"
+#include "ThreadPool.h"
+
+// mkfnet_batch [options] [jobs.ndjson | -]: runs one MKFNet operation per input line,
+// {"id": ..., "operation": "Simulate", "arguments": {...}}, on a thread pool and writes one result line per job,
+// {"index": ..., "id": ..., "operation": ..., "milliseconds": ..., "result": ...} or with "error" instead of "result"
+struct BatchOptions {
+    std::string inputPath = "-";
+    std::string outputPath = "-";
+    size_t numberThreads = 0;
+    size_t maximumJobsInFlight = 0;
+    bool ordered = true;
+    std::string databasesPath;
+};
+
+std::optional<BatchOptions> parse_options(int argc, char** argv) {
+    BatchOptions options;
+    for (int argumentIndex = 1; argumentIndex < argc; argumentIndex++) {
+        std::string argument = argv[argumentIndex];
+        bool hasValue = argumentIndex + 1 < argc;
+        if (argument == "--unordered") {
+            options.ordered = false;
+        }
+        else if (argument == "--threads" && hasValue) {
+            auto numberThreads = MKFNetInternal::parse_count(argv[++argumentIndex]);
+            if (!numberThreads) {
+                return std::nullopt;
+            }
+            options.numberThreads = *numberThreads;
+        }
+        else if (argument == "--max-in-flight" && hasValue) {
+            auto maximumJobsInFlight = MKFNetInternal::parse_count(argv[++argumentIndex]);
+            if (!maximumJobsInFlight) {
+                return std::nullopt;
+            }
+            options.maximumJobsInFlight = *maximumJobsInFlight;
+        }
+        else if (argument == "--databases" && hasValue) {
+            options.databasesPath = argv[++argumentIndex];
+        }
+        else if (argument == "--output" && hasValue) {
+            options.outputPath = argv[++argumentIndex];
+        }
+        else if (argument == "-" || !argument.starts_with("-")) {
+            options.inputPath = argument;
+        }
+        else {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+// Writes result lines as they finish, or holds them back until every earlier line is out when ordered
+class ResultWriter {
+    private:
+        std::ostream& _output;
+        bool _ordered;
+        std::map<size_t, std::string> _pendingLines;
+        size_t _nextIndex = 0;
+        size_t _numberWritten = 0;
+        std::mutex _mutex;
+        std::condition_variable _written;
+
+    public:
+        ResultWriter(std::ostream& output, bool ordered) : _output(output), _ordered(ordered) {}
+
+        void write(size_t index, std::string line) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_ordered) {
+                    _output << line << '\n';
+                    _numberWritten++;
+                }
+                else {
+                    _pendingLines.emplace(index, std::move(line));
+                    for (auto lineIterator = _pendingLines.begin(); lineIterator != _pendingLines.end() && lineIterator->first == _nextIndex; lineIterator = _pendingLines.erase(lineIterator)) {
+                        _output << lineIterator->second << '\n';
+                        _nextIndex++;
+                        _numberWritten++;
+                    }
+                }
+                _output.flush();
+            }
+            _written.notify_all();
+        }
+
+        // Blocks until at most maximumPending of the first numberSubmitted lines are still unwritten
+        void wait_until_pending_at_most(size_t numberSubmitted, size_t maximumPending) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _written.wait(lock, [&] { return numberSubmitted - _numberWritten <= maximumPending; });
+        }
+};
+
+int main(int argc, char** argv) {
+    auto options = parse_options(argc, argv);
+    if (!options) {
+        return MKFNetInternal::print_usage("mkfnet_batch [--threads N] [--unordered] [--max-in-flight N] [--databases DIRECTORY | SNAPSHOT] [--output FILE] [jobs.ndjson | -]");
+    }
+
+    std::ifstream inputFile;
+    if (options->inputPath != "-") {
+        inputFile.open(options->inputPath);
+        if (!inputFile) {
+            std::cerr << "Cannot read " << options->inputPath << std::endl;
+            return 2;
+        }
+    }
+    std::istream& input = options->inputPath == "-"? std::cin : inputFile;
+    std::ofstream outputFile;
+    if (options->outputPath != "-") {
+        outputFile.open(options->outputPath);
+        if (!outputFile) {
+            std::cerr << "Cannot write " << options->outputPath << std::endl;
+            return 2;
+        }
+    }
+    // The library reports some failures on std::cout; those go to stderr so they never land between result lines
+    std::ostream standardOutput(std::cout.rdbuf());
+    auto* coutBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+    std::ostream& output = options->outputPath == "-"? standardOutput : outputFile;
+
+    // Catalogs are loaded once before any worker starts, so no job pays for or races on the first load
+    MKFNet mkfNet;
+    auto catalogsError = MKFNetInternal::warm_up_catalogs(mkfNet, options->databasesPath);
+    if (!catalogsError.empty()) {
+        std::cerr << "Cannot load databases from " << options->databasesPath << ": " << catalogsError << std::endl;
+        std::cout.rdbuf(coutBuffer);
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    MKFNetInternal::OperationRunner operationRunner;
+    ResultWriter writer(output, options->ordered);
+    std::atomic<size_t> numberFailed{0};
+    size_t numberSubmitted = 0;
+    {
+        MKFNetInternal::ThreadPool threadPool(options->numberThreads);
+        size_t maximumJobsInFlight = options->maximumJobsInFlight > 0? options->maximumJobsInFlight : 4 * threadPool.get_number_threads();
+        std::string line;
+        while (std::getline(input, line)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+            // Bounds the memory held by queued jobs and, when ordered, by results waiting for a slow earlier one
+            writer.wait_until_pending_at_most(numberSubmitted, maximumJobsInFlight - 1);
+            size_t index = numberSubmitted++;
+            threadPool.submit([&, index, line = std::move(line)]() {
+                bool failed = false;
+                auto result = operationRunner.run_job(line, index, failed);
+                if (failed) {
+                    numberFailed++;
+                }
+                writer.write(index, std::move(result));
+            });
+        }
+        writer.wait_until_pending_at_most(numberSubmitted, 0);
+    }
+
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout.rdbuf(coutBuffer);
+    std::cerr << "Ran " << numberSubmitted << " jobs, " << numberFailed << " failed, in " << elapsedSeconds << " s" << std::endl;
+    return numberFailed > 0? 1 : 0;
+}
@@ -0,0 +1,64 @@
+#include "MKFNetC.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+// mkfnet <operation> [arguments]: runs one MKFNet operation and prints its result.
+// Arguments are inline JSON, @path to read them from a file, or - to read them from stdin
+int print_usage() {
+    std::cerr << "Usage: mkfnet <operation> [argumentsJson | @argumentsFile | -]" << std::endl;
+    std::cerr << "       mkfnet --list" << std::endl;
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        return print_usage();
+    }
+    std::string operation = argv[1];
+    if (operation == "--list") {
+        char* operationNames = mkfnet_list_operations();
+        std::cout << (operationNames? operationNames : "[]") << std::endl;
+        mkfnet_free_string(operationNames);
+        return 0;
+    }
+
+    std::string arguments;
+    if (argc == 3) {
+        std::string argument = argv[2];
+        if (argument == "-") {
+            arguments.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        }
+        else if (argument.starts_with("@")) {
+            std::ifstream argumentsFile(argument.substr(1), std::ios::binary);
+            if (!argumentsFile) {
+                std::cerr << "Cannot read " << argument.substr(1) << std::endl;
+                return 2;
+            }
+            arguments.assign(std::istreambuf_iterator<char>(argumentsFile), std::istreambuf_iterator<char>());
+        }
+        else {
+            arguments = argument;
+        }
+    }
+
+    mkfnet_handle* handle = mkfnet_create();
+    char* result = mkfnet_call(handle, operation.c_str(), arguments.c_str());
+    int exitCode = 0;
+    if (!result) {
+        std::cerr << "Out of memory" << std::endl;
+        exitCode = 1;
+    }
+    else if (std::strncmp(result, "Exception: ", std::strlen("Exception: ")) == 0) {
+        std::cerr << result << std::endl;
+        exitCode = 1;
+    }
+    else {
+        std::cout << result << std::endl;
+    }
+    mkfnet_free_string(result);
+    mkfnet_destroy(handle);
+    return exitCode;
+}
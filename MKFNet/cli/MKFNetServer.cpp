@@ -0,0 +1,291 @@
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <httplib.h>
+#include <iostream>
+#include <json.hpp>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "MKFNet.h"
+#include "MKFNetDispatcher.h"
+#include "Metrics.h"
+#include "ThreadPool.h"
+
+using json = nlohmann::json;
+
+// mkfnet_server [options]: keeps the catalogs and the MAS store of one process warm and serves MKFNet over HTTP.
+//   POST /call/<operation>  arguments as for mkfnet, answered with the result of the operation
+//   POST /batch             jobs as for mkfnet_batch, one per line, answered with one result line per job in the same order
+//   GET  /metrics           GetMetrics, plus the request and queue counters of the server, with ?reset=true to restart them
+//   GET  /health
+// The server has no authentication. It only listens on a loopback address unless --allow-remote is given,
+// and then refuses the operations that read or write files on the server host
+struct ServerOptions {
+    std::string host = "127.0.0.1";
+    size_t port = 8650;
+    size_t numberThreads = 0;
+    size_t maximumJobsInFlight = 0;
+    bool allowRemote = false;
+    std::string databasesPath;
+};
+
+bool is_loopback_host(const std::string& host) {
+    return host == "localhost" || host == "::1" || host.starts_with("127.");
+}
+
+std::optional<ServerOptions> parse_options(int argc, char** argv) {
+    ServerOptions options;
+    for (int argumentIndex = 1; argumentIndex < argc; argumentIndex++) {
+        std::string argument = argv[argumentIndex];
+        bool hasValue = argumentIndex + 1 < argc;
+        if (argument == "--allow-remote") {
+            options.allowRemote = true;
+        }
+        else if (argument == "--host" && hasValue) {
+            options.host = argv[++argumentIndex];
+        }
+        else if (argument == "--port" && hasValue) {
+            auto port = MKFNetInternal::parse_count(argv[++argumentIndex]);
+            if (!port || *port > 65535) {
+                return std::nullopt;
+            }
+            options.port = *port;
+        }
+        else if (argument == "--threads" && hasValue) {
+            auto numberThreads = MKFNetInternal::parse_count(argv[++argumentIndex]);
+            if (!numberThreads) {
+                return std::nullopt;
+            }
+            options.numberThreads = *numberThreads;
+        }
+        else if (argument == "--max-in-flight" && hasValue) {
+            auto maximumJobsInFlight = MKFNetInternal::parse_count(argv[++argumentIndex]);
+            if (!maximumJobsInFlight) {
+                return std::nullopt;
+            }
+            options.maximumJobsInFlight = *maximumJobsInFlight;
+        }
+        else if (argument == "--databases" && hasValue) {
+            options.databasesPath = argv[++argumentIndex];
+        }
+        else {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+// Every operation but job control runs on one pool sized to the cores, so concurrent requests share the cores instead of
+// each HTTP connection thread computing on its own; the HTTP threads only wait for their results
+class EvaluationServer {
+    private:
+        MKFNetInternal::OperationRunner _operationRunner;
+        MKFNetInternal::ThreadPool _threadPool;
+        size_t _maximumJobsInFlight;
+        bool _allowFileOperations;
+        MKFNetInternal::StageMetrics& _callStage = MKFNetInternal::Metrics::get_instance().get_stage("Server/call");
+        MKFNetInternal::StageMetrics& _batchStage = MKFNetInternal::Metrics::get_instance().get_stage("Server/batch");
+        MKFNetInternal::StageMetrics& _queueStage = MKFNetInternal::Metrics::get_instance().get_stage("Server/queue");
+        std::atomic<uint64_t> _numberRequests{0};
+        std::atomic<uint64_t> _numberRequestsInFlight{0};
+        std::atomic<uint64_t> _numberJobs{0};
+        std::atomic<uint64_t> _numberJobsQueued{0};
+        std::atomic<uint64_t> _numberJobsRunning{0};
+        std::atomic<uint64_t> _numberJobsFailed{0};
+
+        static uint64_t get_nanoseconds_since(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        // Counts a request from its handler starting until it returns
+        class RequestCounter {
+            private:
+                EvaluationServer& _server;
+
+            public:
+                explicit RequestCounter(EvaluationServer& server) : _server(server) {
+                    _server._numberRequests++;
+                    _server._numberRequestsInFlight++;
+                }
+                ~RequestCounter() {
+                    _server._numberRequestsInFlight--;
+                }
+        };
+
+        template<typename Task>
+        std::future<std::string> submit(Task task) {
+            _numberJobs++;
+            _numberJobsQueued++;
+            auto queuedAt = std::chrono::steady_clock::now();
+            return _threadPool.submit([this, task = std::move(task), queuedAt]() {
+                _queueStage.record(get_nanoseconds_since(queuedAt));
+                _numberJobsQueued--;
+                _numberJobsRunning++;
+                auto result = task();
+                _numberJobsRunning--;
+                return result;
+            });
+        }
+
+        static bool is_job_control_job(const std::string& job) {
+            try {
+                auto jobJson = json::parse(job);
+                return jobJson.is_object() && jobJson.contains("operation") && jobJson["operation"].is_string() &&
+                       MKFNetInternal::is_job_control_operation(jobJson["operation"].get<std::string>());
+            }
+            catch (...) {
+                // Malformed lines are reported by run_job like any other failed job
+                return false;
+            }
+        }
+
+    public:
+        EvaluationServer(size_t numberThreads, size_t maximumJobsInFlight, bool allowFileOperations)
+            : _operationRunner(allowFileOperations), _threadPool(numberThreads),
+              _maximumJobsInFlight(maximumJobsInFlight > 0? maximumJobsInFlight : 4 * _threadPool.get_number_threads()),
+              _allowFileOperations(allowFileOperations) {}
+
+        void call(const std::string& operation, const httplib::Request& request, httplib::Response& response) {
+            RequestCounter requestCounter(*this);
+            auto start = std::chrono::steady_clock::now();
+            if (!MKFNetInternal::has_operation(operation)) {
+                response.status = 404;
+                response.set_content(json{{"error", "Unknown operation " + operation}}.dump(), "application/json");
+                return;
+            }
+            if (!_allowFileOperations && MKFNetInternal::is_file_operation(operation)) {
+                response.status = 403;
+                response.set_content(json{{"error", operation + " reads or writes files and is not served to remote clients"}}.dump(), "application/json");
+                return;
+            }
+            // Job control runs on this connection's thread, as WaitJob would otherwise hold a pool worker for as long
+            // as the job it waits for
+            std::string result;
+            if (MKFNetInternal::is_job_control_operation(operation)) {
+                result = _operationRunner.call(operation, request.body);
+            }
+            else {
+                result = submit([this, operation, arguments = request.body]() {
+                    return _operationRunner.call(operation, arguments);
+                }).get();
+            }
+            if (result.starts_with("Exception: ")) {
+                _numberJobsFailed++;
+                response.status = 422;
+                response.set_content(json{{"error", result.substr(std::string("Exception: ").size())}}.dump(-1, ' ', false, json::error_handler_t::replace), "application/json");
+            }
+            else {
+                bool isJson = !result.empty() && json::accept(result);
+                response.set_content(result, isJson? "application/json" : "text/plain");
+            }
+            _callStage.record(get_nanoseconds_since(start));
+        }
+
+        void batch(const httplib::Request& request, httplib::Response& response) {
+            RequestCounter requestCounter(*this);
+            auto start = std::chrono::steady_clock::now();
+            // Results are collected in order as the oldest finishes, so one request never queues more than
+            // _maximumJobsInFlight jobs and a large body cannot crowd out every other request
+            std::deque<std::future<std::string>> results;
+            std::string body;
+            auto collect_oldest = [&]() {
+                body += results.front().get();
+                body += '\n';
+                results.pop_front();
+            };
+            std::istringstream jobs(request.body);
+            std::string job;
+            size_t numberSubmitted = 0;
+            while (std::getline(jobs, job)) {
+                if (job.find_first_not_of(" \t\r") == std::string::npos) {
+                    continue;
+                }
+                if (results.size() >= _maximumJobsInFlight) {
+                    collect_oldest();
+                }
+                auto run_job = [this, job, index = numberSubmitted++]() {
+                    bool failed = false;
+                    auto result = _operationRunner.run_job(job, index, failed);
+                    if (failed) {
+                        _numberJobsFailed++;
+                    }
+                    return result;
+                };
+                if (is_job_control_job(job)) {
+                    std::promise<std::string> result;
+                    result.set_value(run_job());
+                    results.push_back(result.get_future());
+                }
+                else {
+                    results.push_back(submit(std::move(run_job)));
+                }
+            }
+            while (!results.empty()) {
+                collect_oldest();
+            }
+            response.set_content(body, "application/x-ndjson");
+            _batchStage.record(get_nanoseconds_since(start));
+        }
+
+        void metrics(const httplib::Request& request, httplib::Response& response) {
+            MKFNet mkfNet;
+            auto metrics = json::parse(mkfNet.GetMetrics(request.get_param_value("reset") == "true"));
+            metrics["server"]["threads"] = _threadPool.get_number_threads();
+            metrics["server"]["maximumJobsInFlightPerBatch"] = _maximumJobsInFlight;
+            metrics["server"]["requests"] = _numberRequests.load();
+            metrics["server"]["requestsInFlight"] = _numberRequestsInFlight.load();
+            metrics["server"]["jobs"] = _numberJobs.load();
+            metrics["server"]["jobsQueued"] = _numberJobsQueued.load();
+            metrics["server"]["jobsRunning"] = _numberJobsRunning.load();
+            metrics["server"]["jobsFailed"] = _numberJobsFailed.load();
+            response.set_content(metrics.dump(4), "application/json");
+        }
+
+        void register_routes(httplib::Server& server) {
+            server.Post(R"(/call/(\w+))", [this](const httplib::Request& request, httplib::Response& response) {
+                call(request.matches[1].str(), request, response);
+            });
+            server.Post("/batch", [this](const httplib::Request& request, httplib::Response& response) {
+                batch(request, response);
+            });
+            server.Get("/metrics", [this](const httplib::Request& request, httplib::Response& response) {
+                metrics(request, response);
+            });
+            server.Get("/health", [](const httplib::Request&, httplib::Response& response) {
+                response.set_content("ok", "text/plain");
+            });
+        }
+};
+
+int main(int argc, char** argv) {
+    auto options = parse_options(argc, argv);
+    if (!options) {
+        return MKFNetInternal::print_usage("mkfnet_server [--host ADDRESS] [--port PORT] [--allow-remote] [--threads N] [--max-in-flight N] [--databases DIRECTORY | SNAPSHOT]");
+    }
+
+    if (!options->allowRemote && !is_loopback_host(options->host)) {
+        std::cerr << "Refusing to listen on " << options->host << " without --allow-remote: the server has no authentication" << std::endl;
+        return 2;
+    }
+
+    MKFNet mkfNet;
+    auto catalogsError = MKFNetInternal::warm_up_catalogs(mkfNet, options->databasesPath);
+    if (!catalogsError.empty()) {
+        std::cerr << "Cannot load databases from " << options->databasesPath << ": " << catalogsError << std::endl;
+        return 2;
+    }
+
+    EvaluationServer evaluationServer(options->numberThreads, options->maximumJobsInFlight, !options->allowRemote);
+    httplib::Server server;
+    evaluationServer.register_routes(server);
+    if (!server.bind_to_port(options->host, static_cast<int>(options->port))) {
+        std::cerr << "Cannot listen on " << options->host << ":" << options->port << std::endl;
+        return 2;
+    }
+    std::cerr << "Serving MKFNet on http://" << options->host << ":" << options->port << std::endl;
+    return server.listen_after_bind()? 0 : 1;
+}